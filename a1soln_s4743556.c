@@ -15,6 +15,8 @@
 #include <unistd.h>
 #include <getopt.h>
 #include <limits.h>
+#include <stdint.h>
+#include "linereader.h"
 
 // The maximum length of any dictionary word can be assumed to be 50 chars
 #define MAX_DICTIONARY_WORD_LENGTH 50
@@ -38,6 +40,18 @@
 #define LEN_ARG_TEXT "--length"
 #define DICTIONARY_ARG_TEXT "--dict"
 
+// The dictionary hash set has at least this many slots per word, and
+// FNV-1a constants used to hash words into it
+#define HASH_SLOTS_PER_WORD 2
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+// Wildcard pattern keys pack each letter of a word into 5 bits (A=1 .. Z=26)
+// with 0 as the wildcard. They're hashed by multiplying by this constant.
+#define PATTERN_LETTER_BITS 5
+#define PATTERN_NON_LETTER 0x1F
+#define PATTERN_HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
 // Limit on the number of steps that will be permitted by default
 // (i.e. if not specified on the command line)
 #define DEFAULT_STEP_LIMIT 13
@@ -118,11 +132,30 @@ typedef struct {
     char* dictionaryFileName;
 } GameParameters;
 
+// Structure type to hold an open addressing hash set of words that all have
+// the same length. Each slot holds a word packed to wordLen chars (with no
+// terminating null) - an empty slot starts with a null char.
+// Words are also grouped into buckets by each of their wildcard patterns
+// (e.g. CAT is in the buckets for _AT, C_T and CA_) so that the words one 
+// letter away from any word can be found from wordLen buckets. 
+typedef struct {
+    int wordLen;
+    unsigned int numSlots;	// Always a power of two
+    char* slots;
+    unsigned int numBucketSlots;	// Always a power of two
+    uint64_t* bucketKeys;	// Pattern key in each slot, 0 if empty
+    int* bucketOfSlot;		// Bucket number for the key in each slot
+    int* bucketStart;		// Start of each bucket in bucketWords
+    int* bucketWords;		// Word numbers grouped by bucket
+} WordIndex;
+
 // Structure type to hold a list of words - used for the dictionary, as well
-// as the list of entered words
+// as the list of entered words. The dictionary also has an index for fast
+// lookups - this is NULL for other lists.
 typedef struct {
     int numWords;
     char** wordArray;
+    WordIndex* index;
 } WordList;
 
 /* Function prototypes - see descriptions with the functions themselves */
@@ -146,7 +179,13 @@ void free_word_list(WordList words);
 char* convert_word_to_upper_case(char* word);
 bool word_contains_only_letters(const char* word);
 bool is_word_in_list(const char* word, WordList words);
-char* read_line(void);
+uint32_t hash_word(const char* word, int len);
+WordIndex* build_word_index(WordList words, int wordLen);
+uint64_t pattern_key(const char* word, int wordLen, int wildPos);
+unsigned int find_bucket_slot(const WordIndex* index, uint64_t key);
+void build_buckets(WordIndex* index, WordList words);
+int find_neighbours(const char* word, WordList words, int** neighbours);
+int compare_ints(const void* a, const void* b);
 ExitStatus play_game(GameParameters param, WordList words);
 bool check_attempt(const char* attempt, int wordLen, WordList validWords,
 	WordList previousSteps, const char* targetWord);
@@ -543,6 +582,7 @@ WordList read_dictionary(const GameParameters param) {
     // Initialise our list of matches - nothing in it initially.
     validWords.numWords = 0;
     validWords.wordArray = 0;
+    validWords.index = NULL;
 
     // Read lines of file one by one 
     while (fgets(currentWord, WORD_BUFFER_SIZE, fileStream)) {
@@ -560,6 +600,9 @@ WordList read_dictionary(const GameParameters param) {
 	}
     }
     fclose(fileStream);
+
+    // Index the words so that membership checks don't need to scan the list
+    validWords.index = build_word_index(validWords, param.wordLen);
     return validWords;
 }
 
@@ -610,6 +653,14 @@ void free_word_list(WordList words) {
 	free(words.wordArray[i]);
     }
     free(words.wordArray);
+    if (words.index) {
+	free(words.index->slots);
+	free(words.index->bucketKeys);
+	free(words.index->bucketOfSlot);
+	free(words.index->bucketStart);
+	free(words.index->bucketWords);
+	free(words.index);
+    }
 }
 
 /*
@@ -646,9 +697,28 @@ bool word_contains_only_letters(const char* word) {
  * is_word_in_list()
  * 	Returns true if the given word is in the given list of words (words),
  * 	false otherwise. The word and all words in the list are known to be 
- * 	upper case.
+ * 	upper case. Lists with an index (the dictionary) are checked in
+ * 	constant time, others are scanned.
  */
 bool is_word_in_list(const char* word, WordList words) {
+    if (words.index) {
+	// Indexed list - probe the hash set rather than scanning
+	WordIndex* index = words.index;
+	if (strlen(word) != index->wordLen) {
+	    return false;
+	}
+	unsigned int mask = index->numSlots - 1;
+	unsigned int slot = hash_word(word, index->wordLen) & mask;
+	char* entry = index->slots + (size_t)slot * index->wordLen;
+	while (entry[0]) {
+	    if (memcmp(entry, word, index->wordLen) == 0) {
+		return true;
+	    }
+	    slot = (slot + 1) & mask;
+	    entry = index->slots + (size_t)slot * index->wordLen;
+	}
+	return false;
+    }
     for (int i = 0; i < words.numWords; i++) {
 	if (strcmp(words.wordArray[i], word) == 0) {
 	    return true;
@@ -659,31 +729,193 @@ bool is_word_in_list(const char* word, WordList words) {
 }
 
 /*
- * read_line()
- *	Read a line of indeterminate length from stdin (i.e. we read
- * 	characters until we reach a newline or EOF). If we hit EOF at 
- *	the start of the line then we return NULL, otherwise we 
- *	return the line of text (without any newline) in dynamically 
- *	allocated memory.
+ * hash_word()
+ * 	Returns the FNV-1a hash of the first len characters of word.
  */
-char* read_line(void) {
-    char* buffer = NULL;
-    int bufSize = 0;
-    int character;
-
-    while (character = fgetc(stdin), (character != EOF && character != '\n')) {
-	// Got a character - grow the buffer and put it in the buffer
-	buffer = realloc(buffer, bufSize + 1);
-	buffer[bufSize] = character;
-	bufSize++;
-    }
-    // Got EOF or newline
-    if (character == '\n' || bufSize > 0) {
-	// Have a line to return - grow the buffer and null terminate it
-	buffer = realloc(buffer, bufSize + 1);
-	buffer[bufSize] = '\0';
-    } // else got EOF at start of line - we'll be returning NULL
-    return buffer;
+uint32_t hash_word(const char* word, int len) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (int i = 0; i < len; i++) {
+	hash ^= (unsigned char)word[i];
+	hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * build_word_index()
+ * 	Build and return an open addressing hash set containing every word
+ * 	in the given list (words). All words must be wordLen chars long.
+ * 	Collisions are resolved by linear probing.
+ */
+WordIndex* build_word_index(WordList words, int wordLen) {
+    WordIndex* index = malloc(sizeof(WordIndex));
+    index->wordLen = wordLen;
+    // Table size is a power of two so that hashes can be masked
+    index->numSlots = 1;
+    while (index->numSlots < (unsigned int)words.numWords * 
+	    HASH_SLOTS_PER_WORD) {
+	index->numSlots <<= 1;
+    }
+    index->slots = calloc(index->numSlots, wordLen);
+    unsigned int mask = index->numSlots - 1;
+    for (int i = 0; i < words.numWords; i++) {
+	const char* word = words.wordArray[i];
+	unsigned int slot = hash_word(word, wordLen) & mask;
+	char* entry = index->slots + (size_t)slot * wordLen;
+	// Probe until we find an empty slot (or the same word - dictionaries
+	// can contain a word more than once in different cases)
+	while (entry[0] && memcmp(entry, word, wordLen) != 0) {
+	    slot = (slot + 1) & mask;
+	    entry = index->slots + (size_t)slot * wordLen;
+	}
+	memcpy(entry, word, wordLen);
+    }
+    build_buckets(index, words);
+    return index;
+}
+
+/*
+ * pattern_key()
+ * 	Returns the wildcard pattern key for the given word - each letter
+ * 	packed into 5 bits with the letter at wildPos replaced by a wildcard.
+ * 	Words that only differ at wildPos have the same key.
+ */
+uint64_t pattern_key(const char* word, int wordLen, int wildPos) {
+    uint64_t key = 0;
+    for (int i = 0; i < wordLen; i++) {
+	uint64_t code = 0;
+	if (i != wildPos) {
+	    // Anything that isn't a letter can't match a dictionary word
+	    code = isalpha((unsigned char)word[i]) ?
+		    toupper((unsigned char)word[i]) - 'A' + 1 : 
+		    PATTERN_NON_LETTER;
+	}
+	key = (key << PATTERN_LETTER_BITS) | code;
+    }
+    return key;
+}
+
+/*
+ * find_bucket_slot()
+ * 	Returns the slot in the bucket hash table of the index that holds
+ * 	the given pattern key, or the empty slot it would be inserted into.
+ */
+unsigned int find_bucket_slot(const WordIndex* index, uint64_t key) {
+    unsigned int mask = index->numBucketSlots - 1;
+    unsigned int slot = 
+	    (unsigned int)((key * PATTERN_HASH_MULTIPLIER) >> 32) & mask;
+    while (index->bucketKeys[slot] && index->bucketKeys[slot] != key) {
+	slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*
+ * build_buckets()
+ * 	Group all the given words (which the index has been built for) into
+ * 	buckets by their wildcard patterns. We count the size of each bucket
+ * 	in a first pass, then fill them in a second pass so that each bucket
+ * 	lists its words in the same order as the list.
+ */
+void build_buckets(WordIndex* index, WordList words) {
+    int wordLen = index->wordLen;
+    int numEntries = words.numWords * wordLen;
+    index->numBucketSlots = 1;
+    while (index->numBucketSlots < (unsigned int)numEntries * 
+	    HASH_SLOTS_PER_WORD) {
+	index->numBucketSlots <<= 1;
+    }
+    index->bucketKeys = calloc(index->numBucketSlots, sizeof(uint64_t));
+    index->bucketOfSlot = malloc(sizeof(int) * index->numBucketSlots);
+
+    // Count the words in each bucket. Counts are stored one place along so
+    // that a running sum turns them into the start of each bucket.
+    int* counts = calloc(numEntries + 1, sizeof(int));
+    int numBuckets = 0;
+    for (int i = 0; i < words.numWords; i++) {
+	for (int pos = 0; pos < wordLen; pos++) {
+	    uint64_t key = pattern_key(words.wordArray[i], wordLen, pos);
+	    unsigned int slot = find_bucket_slot(index, key);
+	    if (!index->bucketKeys[slot]) {
+		// First time we've seen this pattern - new bucket
+		index->bucketKeys[slot] = key;
+		index->bucketOfSlot[slot] = numBuckets++;
+	    }
+	    counts[index->bucketOfSlot[slot] + 1]++;
+	}
+    }
+    for (int b = 0; b < numBuckets; b++) {
+	counts[b + 1] += counts[b];
+    }
+    index->bucketStart = counts;
+
+    // Fill the buckets
+    index->bucketWords = malloc(sizeof(int) * (numEntries + 1));
+    int* next = malloc(sizeof(int) * (numBuckets + 1));
+    memcpy(next, counts, sizeof(int) * (numBuckets + 1));
+    for (int i = 0; i < words.numWords; i++) {
+	for (int pos = 0; pos < wordLen; pos++) {
+	    uint64_t key = pattern_key(words.wordArray[i], wordLen, pos);
+	    int bucket = index->bucketOfSlot[find_bucket_slot(index, key)];
+	    index->bucketWords[next[bucket]++] = i;
+	}
+    }
+    free(next);
+}
+
+/*
+ * find_neighbours()
+ * 	Find all words in the given indexed list (words) that differ from
+ * 	the given word by exactly one character. The word numbers are 
+ * 	returned (in list order) in a dynamically allocated array that is
+ * 	stored in *neighbours, and we return how many were found.
+ */
+int find_neighbours(const char* word, WordList words, int** neighbours) {
+    const WordIndex* index = words.index;
+    int bucketForPos[MAX_WORD_LENGTH];
+    int total = 0;
+    for (int pos = 0; pos < index->wordLen; pos++) {
+	unsigned int slot = find_bucket_slot(index,
+		pattern_key(word, index->wordLen, pos));
+	if (index->bucketKeys[slot]) {
+	    int bucket = index->bucketOfSlot[slot];
+	    bucketForPos[pos] = bucket;
+	    total += index->bucketStart[bucket + 1] - 
+		    index->bucketStart[bucket];
+	} else {
+	    bucketForPos[pos] = -1;	// No words match this pattern
+	}
+    }
+    *neighbours = malloc(sizeof(int) * (total + 1));
+    int count = 0;
+    for (int pos = 0; pos < index->wordLen; pos++) {
+	int bucket = bucketForPos[pos];
+	if (bucket < 0) {
+	    continue;
+	}
+	for (int j = index->bucketStart[bucket];
+		j < index->bucketStart[bucket + 1]; j++) {
+	    int wordNum = index->bucketWords[j];
+	    // The word itself (if present) is in all of its buckets - skip it
+	    if (words.wordArray[wordNum][pos] != word[pos]) {
+		(*neighbours)[count++] = wordNum;
+	    }
+	}
+    }
+    // Each neighbour is in exactly one of the buckets, so we just need to
+    // put them back into list order.
+    qsort(*neighbours, count, sizeof(int), compare_ints);
+    return count;
+}
+
+/*
+ * compare_ints()
+ * 	qsort() comparison function to sort ints into ascending order.
+ */
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
 }
 
 /*
@@ -696,6 +928,8 @@ ExitStatus play_game(GameParameters param, WordList dictionary) {
     int numStepsMade = 0;
     bool success = false;
     WordList previousSteps = {0, NULL};
+    LineReader input;
+    open_reader(&input, STDIN_FILENO);
     previousSteps = add_word_to_list(previousSteps, param.startWord);
 
     printf("Welcome to UQWordLadder!\n");
@@ -705,8 +939,9 @@ ExitStatus play_game(GameParameters param, WordList dictionary) {
     while (numStepsMade < param.stepLimit) {
 	// Prompt for word
 	printf("Enter word %d (or ? for help):\n", numStepsMade + 1);
-	// Read line of text from user. Abort if EOF.
-	char* attempt = read_line();
+	// Read line of text from user. Abort if EOF. The line is only valid
+	// until the next one is read - the list of steps keeps its own copy.
+	char* attempt = next_line(&input);
 	if (!attempt) {
 	    break; // EOF
 	}
@@ -722,16 +957,15 @@ ExitStatus play_game(GameParameters param, WordList dictionary) {
 		numStepsMade++;
 		if (strcmp(attempt, param.endWord) == 0) { // Got it!
 		    success = true;
-		    free(attempt);
 		    break;
 		}
 		previousSteps = add_word_to_list(previousSteps, attempt);
 	    }
 	}
-	free(attempt);
     }
     // Tidy up, print the appropriate message to the user and return
     free_word_list(previousSteps);
+    close_reader(&input);
     if (success) {
 	printf(MSG_GAME_OVER_SUCCESS, numStepsMade);
 	return OK;
@@ -801,9 +1035,17 @@ void print_suggestions(WordList previousSteps, WordList validWords,
 	havePrintedHeader = true;
 	printf(" %s\n", targetWord);
     }
-    // Iterate over all the valid words in the dictionary
-    for (int i = 0; i < validWords.numWords; i++) {
-	char* wordToCheck = validWords.wordArray[i];
+    // Candidates are the words one letter away from the last word. If the
+    // dictionary is indexed we can get these straight from the buckets,
+    // otherwise we check all the valid words in the dictionary.
+    int* neighbours = NULL;
+    int numCandidates = validWords.numWords;
+    if (validWords.index) {
+	numCandidates = find_neighbours(lastWord, validWords, &neighbours);
+    }
+    for (int n = 0; n < numCandidates; n++) {
+	int wordNum = neighbours ? neighbours[n] : n;
+	char* wordToCheck = validWords.wordArray[wordNum];
 	if (words_differ_by_one_char(lastWord, wordToCheck)  &&
 		!is_word_in_list(wordToCheck, previousSteps) &&
 		strcmp(targetWord, wordToCheck)) {
@@ -816,6 +1058,7 @@ void print_suggestions(WordList previousSteps, WordList validWords,
 	    printf(" %s\n", wordToCheck);
 	}
     }
+    free(neighbours);
     // if we've printed some suggestions, then print the "footer" for this
     // list, otherwise print that we didn't find any.
     if (havePrintedHeader) {
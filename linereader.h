@@ -0,0 +1,122 @@
+/*
+ * linereader.h
+ *      Buffered line reading shared by uqwordladder, its reference
+ *      solution and testuqwordladder. Input is read in large blocks and
+ *      lines are handed back from one reusable buffer, instead of growing
+ *      a new string a character at a time.
+ */
+
+#ifndef LINEREADER_H
+#define LINEREADER_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LINE_BLOCK_SIZE 65536
+
+/*Block buffered reader of the lines of a file descriptor*/
+typedef struct {
+    int fd; //file descriptor lines are read from
+    char* buffer; //bytes read but not yet handed back, from start to end
+    size_t capacity; //size of buffer
+    size_t start; //first byte of buffer not yet handed back
+    size_t end; //end of the bytes read into buffer
+    bool eof; //if the file descriptor has no more to read
+} LineReader;
+
+/* open_reader()
+* −−−−−−−−−−−−−−−
+* Sets up a reader of the lines of a file descriptor. Nothing is read
+* until the first line is asked for.
+*
+* reader: the reader to set up
+* fd: file descriptor to read, still owned by the caller
+*
+* Returns: Nothing
+*/
+static void open_reader(LineReader* reader, int fd) {
+    reader->fd = fd;
+    reader->buffer = (char* )malloc(LINE_BLOCK_SIZE + 1);
+    reader->capacity = LINE_BLOCK_SIZE;
+    reader->start = 0;
+    reader->end = 0;
+    reader->eof = false;
+}
+
+/* next_line()
+* −−−−−−−−−−−−−−−
+* Reads the next line, up to a newline or the end of the file. Reads are
+* only made when the buffer holds no whole line, and each asks for as
+* much as the buffer has room for.
+*
+* reader: the reader
+*
+* Returns: the line without its newline, null terminated. It lives in the
+* reader's buffer, so may be changed in place but is only valid until the
+* next call. NULL if the end of the file was reached at the start of a
+* line.
+*/
+static char* next_line(LineReader* reader) {
+    size_t scanned = reader->start;
+    while (true) {
+        char* newline = memchr(reader->buffer + scanned, '\n',
+                reader->end - scanned);
+        if (newline != NULL || (reader->eof && reader->end > reader->start)) {
+            char* line = reader->buffer + reader->start;
+            if (newline == NULL) {
+                //the last line had no newline, there is always room here
+                newline = reader->buffer + reader->end;
+            }
+            *newline = '\0';
+            reader->start = newline - reader->buffer + 1;
+            if (reader->start > reader->end) {
+                reader->start = reader->end;
+            }
+            return line;
+        }
+        if (reader->eof) {
+            return NULL;
+        }
+        //keep the partial line, moving it to the front or growing for it
+        scanned = reader->end;
+        if (reader->start > 0) {
+            memmove(reader->buffer, reader->buffer + reader->start,
+                    reader->end - reader->start);
+            scanned -= reader->start;
+            reader->end -= reader->start;
+            reader->start = 0;
+        }
+        if (reader->end == reader->capacity) {
+            reader->capacity *= 2;
+            reader->buffer = (char* )realloc(reader->buffer,
+                    reader->capacity + 1);
+        }
+        ssize_t got = read(reader->fd, reader->buffer + reader->end,
+                reader->capacity - reader->end);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        } else if (got <= 0) {
+            reader->eof = true;
+        } else {
+            reader->end += got;
+        }
+    }
+}
+
+/* close_reader()
+* −−−−−−−−−−−−−−−
+* Frees a reader's buffer. Its file descriptor is left open.
+*
+* reader: the reader
+*
+* Returns: Nothing
+*/
+static void close_reader(LineReader* reader) {
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+#endif
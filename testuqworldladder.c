@@ -6,6 +6,7 @@
  */
 
 // includes
+#define _GNU_SOURCE
 #include <time.h>
 #include <fcntl.h>
 #include <ctype.h>
@@ -15,18 +16,26 @@
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <poll.h>
 #include <sys/time.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <csse2310a3.h>
+#include "linereader.h"
 
 // constants
 #define GOOD_PROG "good-uqwordladder"
+#define DEF_DICT "/usr/share/dict/words"
+#define DICT_ARG "--dict"
 #define JOBDIR_DEF "./tmp"
 #define USAGE_ERROR "Usage: testuqwordladder [--diffshow N] [--jobdir dir]\
- [--regenerate] jobfile program"
+ [--regenerate] [--jobs N] jobfile program"
 #define USAGE_ERROR_CODE 3
 #define JOBFILE_ERROR "testuqwordladder: Unable to open file \"%s\"\n"
 #define JOBFILE_ERROR_CODE 6
@@ -45,6 +54,7 @@
 #define DIR_FAIL_CODE 16
 #define FILE_FAIL "testuqwordladder: Unable to open file \"%s\" for writing\n"
 #define FILE_FAIL_CODE 15
+#define RENAME_FAIL "testuqwordladder: Unable to rename \"%s\" to \"%s\"\n"
 #define NO_TESTS "testuqwordladder: No tests have been finished\n"
 #define NO_TESTS_CODE 9
 #define STDOUT_MATCH "Job %s: Stdout matches\n"
@@ -59,11 +69,24 @@
 #define EXIT_STAT_FILE "%s/%s.exitstatus"
 #define STDOUT_FILE "%s/%s.stdout"
 #define STDERR_FILE "%s/%s.stderr"
-#define NULL_FILE "/dev/null"
+#define TEMP_SUFFIX ".tmp"
+#define MANIFEST_FILE "%s/manifest"
+#define MANIFEST_LINE "%s\t%016" PRIx64 "\n"
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
 #define READ_END 0
 #define WRITE_END 1
 #define PROG_FAIL 12
 #define PROG_SUCCESS 0
+#define TEST_TIME_DEF 1.5
+#define TEST_TIME_MAX 86400.0 // a day, well inside a long of nanoseconds
+#define TIMEOUT_FIELD "timeout="
+#define NSEC_PER_SEC 1000000000L
+#define NSEC_PER_MSEC 1000000L
+#define POLL_FALLBACK_MS 10
+#define CHUNK_SIZE 65536
+#define FDS_PER_TEST 3
+#define MAX_ARGS 8
 
 // global variable
 
@@ -80,6 +103,7 @@ typedef struct {
     char* testId;
     char* inFileName;
     char** givenArgs;
+    double timeout; // seconds the job can run for before it is killed
 } Job;
 
 // Structure type that holds all the jobs to be run and how many there are
@@ -94,9 +118,63 @@ typedef struct {
     char* program;
     bool regen;
     char* jobdir;
+    int numWorkers; // max number of test jobs run at once
     Alljobs alljobs;
 } Data;
 
+// Structure type that holds a test job whose expected output is being
+// regenerated
+typedef struct {
+    pid_t pid; // 0 if no test job is being regenerated in this slot
+    int jobIndex;
+} RegenRun;
+
+// Structure type that holds the manifest of the job directory, which 
+// records a hash of what each test job's expected output was generated from
+typedef struct {
+    uint64_t* recorded; // hash in the manifest for each job, 0 if none
+    uint64_t* current; // hash of each job's args, input and reference
+    bool* upToDate; // if each job's expected output is from current
+} Manifest;
+
+// Structure type that holds the hash of the contents of a file, so a file
+// named by many test jobs is only read once
+typedef struct {
+    dev_t dev;
+    ino_t ino;
+    uint64_t hash;
+} FileHash;
+
+// Structure type that holds the hashes of the files read so far this run
+typedef struct {
+    int numFiles;
+    FileHash* files;
+} FileHashes;
+
+// Structure type that holds the comparison of an output of the program
+// with the expected output, as it is read from the pipe
+typedef struct {
+    int fd; // read end of the pipe, -1 once closed
+    char* expected; // mapped expected output file, NULL if empty
+    size_t expectedSize;
+    size_t matched; // number of bytes read so far that matched
+    bool differs;
+} OutputCheck;
+
+// Structure type that holds the state of a test job once it is started
+typedef struct {
+    bool started;
+    bool finished;
+    bool announced; // if the "Running test" message has been printed
+    pid_t progPid;
+    int pidfd; // -1 once reaped or if pidfds are unsupported
+    bool exited;
+    int status; // exit status of the program
+    OutputCheck out;
+    OutputCheck err;
+    struct timespec deadline; // time the test job is killed at
+} TestRun;
+
 // functions
 
 /* interrupt_handler()
@@ -164,17 +242,6 @@ void gen_message(char* message, Job curJob){
     fflush(stdout);
 }
 
-/* file_fail()
-* −----------------
-* Prints message to stderr that the file failed to open
-*
-* fileName: The name of the file that failed to open
-*/
-void file_fail(char* fileName) {
-    fprintf(stderr, FILE_FAIL, fileName);
-    exit(FILE_FAIL_CODE);
-}
-
 /* error_message()
 * −----------------
 * Prints message to stderr depending on the exit code given
@@ -202,9 +269,31 @@ void error_message(int exitCode, Data data) {
     exit(exitCode);
 }
 
+/* check_number()
+* −----------------
+* Checks to see if the string is a positive number that fits in an int
+*
+* number: The string to check
+*
+* Returns: true if the string is a positive number
+*/
+bool check_number(const char* number) {
+    if (number[0] < '1' || number[0] > '9' || strlen(number) > 9) {
+        return false;
+    }
+    for (int i = 1; number[i]; i++) {
+        if (!isdigit(number[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* check_command_line()
 * −−−−−−−−−−−−−−−
 * Checks to see if command line inputs given are valid
+* --jobs takes the number of test jobs to run at once, a whole number from
+* 1 to 999999999 with no sign or leading zeros (default 1)
 *
 * data: Struct containing all the data for the program.
 * argc: Number of command line arguments
@@ -215,7 +304,7 @@ void error_message(int exitCode, Data data) {
 */
 Data check_command_line(Data data, int argc, char* argv[]) {
 
-    if (argc < 3 || argc > 6) {
+    if (argc < 3 || argc > MAX_ARGS) {
         error_exit(USAGE_ERROR, USAGE_ERROR_CODE);
     }
 
@@ -230,6 +319,10 @@ Data check_command_line(Data data, int argc, char* argv[]) {
                 }
             } else if (strcmp(argv[i], "--regenerate") == 0 && !data.regen) {
                 data.regen = true;
+            } else if (strcmp(argv[i], "--jobs") == 0 && !data.numWorkers
+                    && i + 1 < argc - 2 && check_number(argv[i + 1])) {
+                data.numWorkers = atoi(argv[i + 1]);
+                i++; // skip number argument
             } else {
                 error_message(USAGE_ERROR_CODE, data);
             }
@@ -238,6 +331,9 @@ Data check_command_line(Data data, int argc, char* argv[]) {
     if (!data.jobdir) {
         data.jobdir = JOBDIR_DEF;
     }
+    if (!data.numWorkers) {
+        data.numWorkers = 1;
+    }
 
     data.jobFile = argv[argc - 2];
     data.program = argv[argc - 1];
@@ -299,6 +395,30 @@ void check_jobfile(Data data, int numArgs, char* testId, int jobFileCount,
     }
 }
 
+/* check_timeout()
+* −----------------
+* Checks the value of a timeout field in the jobfile
+*
+* data: Struct containing all the data for the program.
+* value: The text after "timeout="
+* jobFileCount: The line number of the current line of the jobfile
+*
+* Returns: the timeout in seconds
+* Errors: if the timeout is not a positive number no more than
+* TEST_TIME_MAX, which also rejects inf and nan
+*/
+double check_timeout(Data data, char* value, int jobFileCount) {
+    char* end;
+    double timeout = strtod(value, &end);
+    if (end == value || *end != '\0' ||
+            !(timeout > 0 && timeout <= TEST_TIME_MAX)) {
+        fprintf(stderr, JOB_ERROR, jobFileCount, data.jobFile);
+        free_jobfile_one_plus(data, jobFileCount);
+        exit(JOB_ERROR_CODE);
+    }
+    return timeout;
+}
+
 /* reead_jobfile()
 * −----------------
 * Reads the jobfile and stores the information in a Job struct, then stored in 
@@ -311,17 +431,19 @@ void check_jobfile(Data data, int numArgs, char* testId, int jobFileCount,
 */
 Alljobs read_jobfile(Data data) {
     Alljobs jobs = { .numJobs = 0, .jobs = NULL};
-    FILE* jobFile = fopen(data.jobFile, "r");
-    if (!jobFile) { 
+    int jobFd = open(data.jobFile, O_RDONLY);
+    if (jobFd == -1) { 
         error_message(JOBFILE_ERROR_CODE, data); 
     }
+    // lines are read in blocks, each only lasting until the next is read
+    LineReader jobFile;
+    open_reader(&jobFile, jobFd);
     char* line;
     int jobFileCount = 0;
-    while ((line = read_line(jobFile)) != NULL) {
+    while ((line = next_line(&jobFile)) != NULL) {
         int numArgs = 0;
         jobFileCount++;
         if (line[0] == '#' || line[0] == '\n' || line[0] == '\0') {
-            free(line);
             continue;
         }
         char** values = split_string(line, '\t');
@@ -329,6 +451,15 @@ Alljobs read_jobfile(Data data) {
             numArgs++;
         }
         check_jobfile(data, numArgs, values[0], jobFileCount, jobs);
+        // optional timeout field comes before the program arguments
+        double timeout = TEST_TIME_DEF;
+        int firstArg = 2;
+        if (numArgs > 2 && strncmp(values[2], TIMEOUT_FIELD, 
+                strlen(TIMEOUT_FIELD)) == 0) {
+            timeout = check_timeout(data, values[2] + strlen(TIMEOUT_FIELD),
+                    jobFileCount);
+            firstArg = 3;
+        }
         char* testId = strdup(values[0]);
         char* inFileName = strdup(values[1]);
         FILE* inFile = fopen(inFileName, "r");
@@ -340,19 +471,20 @@ Alljobs read_jobfile(Data data) {
         }
         jobs.numJobs++;
         jobs.jobs = (Job*) realloc(jobs.jobs, jobs.numJobs * sizeof(Job));
-        Job curJob = { .numArgs = numArgs, .testId = testId,
-            .inFileName = inFileName, .givenArgs = NULL};
+        // numArgs counts the test id and input file, but not the timeout
+        Job curJob = { .numArgs = numArgs - (firstArg - 2), .testId = testId,
+            .inFileName = inFileName, .givenArgs = NULL, .timeout = timeout};
         curJob.givenArgs = malloc((curJob.numArgs - 2 + 1) * sizeof(char*));
-        for (int i = 2; i < numArgs; i++) {
-            curJob.givenArgs[i - 2] = strdup(values[i]);
+        for (int i = firstArg; i < numArgs; i++) {
+            curJob.givenArgs[i - firstArg] = strdup(values[i]);
         }
-        curJob.givenArgs[numArgs - 2] = NULL;
+        curJob.givenArgs[curJob.numArgs - 2] = NULL;
         jobs.jobs[jobs.numJobs - 1] = curJob;
-        free(line);
         free(values);
         fclose(inFile);
     }
-    fclose(jobFile);
+    close_reader(&jobFile);
+    close(jobFd);
     if (jobs.numJobs == 0) {
         error_message(JOBFILE_EMPTY_CODE, data);
     }
@@ -378,137 +510,517 @@ Data make_jobdir(Data data) {
     return data;
 }
 
-/* open_files()
+/* expected_file()
 * −----------------
-* Opens the files for the given test job
-* Runs the good-uqwordladder program with the given arguments
-* Stores its output in the corresponding files
+* Makes the name of an expected output file of a test job, or the name of
+* the temporary file it is written to before being renamed into place
 *
-* inFileName: The name of the input file
-* outFileName: The name of the output file
-* errFileName: The name of the error file
-* statusFileName: The name of the status file
-* modArgs: The arguments for the uqwordladder with the program name
-* testId: The testId of the current test job
+* format: The format of the file name (STDOUT_FILE, STDERR_FILE or
+*         EXIT_STAT_FILE)
+* data: Struct containing all the data for the program.
+* testId: The testId of the test job
+* temp: true for the name of the temporary file
 *
-* Errors: if the files cannot be opened
+* Returns: the file name, which must be freed
 */
-void open_files(char* inFileName, char* outFileName, char* errFileName, 
-        char* statusFileName, char** modArgs, char* testId) {
-    regen_message(testId);
-    FILE* inFile = fopen(inFileName, "r");
-    FILE* outFile = fopen(outFileName, "w");
-    if (!outFile) {
-        fclose(inFile); 
-        file_fail(outFileName);
-    }
-    FILE* errFile = fopen(errFileName, "w");
-    if (!errFile) {
-        fclose(inFile); 
-        fclose(outFile);
-        file_fail(errFileName);
-    }
-    FILE* statusFile = fopen(statusFileName, "w");
-    if (!statusFile) {
-        fclose(inFile); 
-        fclose(outFile);
-        fclose(errFile);
-        file_fail(statusFileName);
+char* expected_file(char* format, Data data, char* testId, bool temp) {
+    // +18 = strlen("/.exitstatus.tmp\0") and a little more
+    char* fileName = malloc(strlen(data.jobdir) + strlen(testId) + 18);
+    sprintf(fileName, format, data.jobdir, testId);
+    if (temp) {
+        strcat(fileName, TEMP_SUFFIX);
     }
+    return fileName;
+}
 
+/* abort_regen()
+* −----------------
+* Kills and reaps all the regenerations in progress and removes their
+* temporary files, so no expected output is left half written
+*
+* data: Struct containing all the data for the program.
+* regens: The regenerations, one per worker
+*/
+void abort_regen(Data data, RegenRun* regens) {
+    char* formats[] = {STDOUT_FILE, STDERR_FILE, EXIT_STAT_FILE};
+    for (int i = 0; i < data.numWorkers; i++) {
+        if (regens[i].pid) {
+            kill(regens[i].pid, SIGKILL);
+            waitpid(regens[i].pid, NULL, 0);
+            regens[i].pid = 0;
+            char* testId = data.alljobs.jobs[regens[i].jobIndex].testId;
+            for (int j = 0; j < 3; j++) {
+                char* tempName = expected_file(formats[j], data, testId, 
+                        true);
+                unlink(tempName);
+                free(tempName);
+            }
+        }
+    }
+}
+
+/* open_temp()
+* −----------------
+* Opens the temporary file an expected output file is written to
+* If it can't be opened, the other regenerations are aborted and every
+* temporary file of this test job is closed and removed, as the job isn't
+* in a slot of regens for abort_regen() to find
+*
+* format: The format of the expected output file name
+* data: Struct containing all the data for the program.
+* testId: The testId of the test job
+* regens: The regenerations, one per worker
+* opened: A temporary file of this test job already open, or -1
+*
+* Returns: the file descriptor of the temporary file
+* Errors: if the file cannot be opened
+*/
+int open_temp(char* format, Data data, char* testId, RegenRun* regens,
+        int opened) {
+    char* tempName = expected_file(format, data, testId, true);
+    int fd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 
+            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    free(tempName);
+    if (fd == -1) {
+        abort_regen(data, regens);
+        if (opened != -1) {
+            close(opened);
+        }
+        char* formats[] = {STDOUT_FILE, STDERR_FILE, EXIT_STAT_FILE};
+        for (int i = 0; i < 3; i++) {
+            tempName = expected_file(formats[i], data, testId, true);
+            unlink(tempName);
+            free(tempName);
+        }
+        char* fileName = expected_file(format, data, testId, false);
+        fprintf(stderr, FILE_FAIL, fileName);
+        free(fileName);
+        exit(FILE_FAIL_CODE);
+    }
+    return fd;
+}
+
+/* start_regen()
+* −----------------
+* Starts regenerating the expected output of a test job
+* Runs the good-uqwordladder program with the given arguments, with its 
+* stdout and stderr written to temporary files
+*
+* data: Struct containing all the data for the program.
+* jobIndex: The index of the test job
+* regens: The regenerations, one per worker
+* slot: The free slot of regens to use
+*
+* Errors: if the files cannot be opened
+*/
+void start_regen(Data data, int jobIndex, RegenRun* regens, int slot) {
+    Job curJob = data.alljobs.jobs[jobIndex];
+    regen_message(curJob.testId);
+    int outFile = open_temp(STDOUT_FILE, data, curJob.testId, regens, -1);
+    int errFile = open_temp(STDERR_FILE, data, curJob.testId, regens, 
+            outFile);
     pid_t pid = fork();
     if (pid == 0) {
         // redirect stdin, stdout, stderr to corresponding files
-        dup2(fileno(inFile), STDIN_FILENO);
-        dup2(fileno(outFile), STDOUT_FILENO);
-        dup2(fileno(errFile), STDERR_FILENO);
-        fclose(inFile); 
-        fclose(outFile);
-        fclose(errFile);
-        fclose(statusFile);
+        int inFile = open(curJob.inFileName, O_RDONLY);
+        if (inFile == -1) {
+            exit(99); // never read the terminal in place of the input
+        }
+        dup2(inFile, STDIN_FILENO);
+        dup2(outFile, STDOUT_FILENO);
+        dup2(errFile, STDERR_FILENO);
+        close(inFile);
+        char* modArgs[curJob.numArgs];
+        modArgs[0] = GOOD_PROG; 
+        for (int j = 0; j < curJob.numArgs - 2; j++) {
+            modArgs[j + 1] = curJob.givenArgs[j];
+        }
+        modArgs[curJob.numArgs - 1] = NULL;
         execvp(GOOD_PROG, modArgs);
-    } else {
-        int status;
-        waitpid(pid, &status, 0);
-        fprintf(statusFile, "%d\n", WEXITSTATUS(status));
+        exit(99);
     }
-    fclose(inFile); 
-    fclose(outFile);
-    fclose(errFile);
-    fclose(statusFile);
+    close(outFile);
+    close(errFile);
+    regens[slot].pid = pid;
+    regens[slot].jobIndex = jobIndex;
 }
 
-/* check_regen()
+/* finish_regen()
 * −----------------
-* Checks to see if the expected output files needs to be regenerated
+* Writes the exit status of a regenerated test job and renames all its 
+* temporary files into place, with the exit status file last
+* If a rename fails, its temporary file is removed and the test job is
+* left out of date so it is regenerated next time
 *
 * data: Struct containing all the data for the program.
-* outFileName: The name of the output file
-* errFileName: The name of the error file
-* statusFileName: The name of the status file
+* regens: The regenerations, one per worker
+* slot: The slot of regens that has finished
+* status: The status of the good-uqwordladder program from waitpid
+* manifest: The manifest, updated to say if the test job is up to date
 *
-* Returns: updated data struct
+* Errors: if the exit status file cannot be opened
 */
-Data check_regen(Data data, char* outFileName, char* errFileName, 
-        char* statusFileName) {
-    struct stat jobSpecStat, outFileStat, errFileStat, statusFileStat;
+void finish_regen(Data data, RegenRun* regens, int slot, int status, 
+        Manifest manifest) {
+    char* testId = data.alljobs.jobs[regens[slot].jobIndex].testId;
+    regens[slot].pid = 0;
+    int statusFile = open_temp(EXIT_STAT_FILE, data, testId, regens, -1);
+    dprintf(statusFile, "%d\n", WEXITSTATUS(status));
+    close(statusFile);
+    char* formats[] = {STDOUT_FILE, STDERR_FILE, EXIT_STAT_FILE};
+    bool renamed = true;
+    for (int i = 0; i < 3; i++) {
+        char* tempName = expected_file(formats[i], data, testId, true);
+        char* fileName = expected_file(formats[i], data, testId, false);
+        if (rename(tempName, fileName) != 0) {
+            fprintf(stderr, RENAME_FAIL, tempName, fileName);
+            unlink(tempName);
+            renamed = false;
+        }
+        free(tempName);
+        free(fileName);
+    }
+    manifest.upToDate[regens[slot].jobIndex] = renamed;
+}
 
-    stat(data.jobFile, &jobSpecStat);
+/* hash_bytes()
+* −----------------
+* Adds bytes to a 64-bit FNV-1a hash
+*
+* hash: The hash so far
+* bytes: The bytes to add
+* len: The number of bytes
+*
+* Returns: the updated hash
+*/
+uint64_t hash_bytes(uint64_t hash, const void* bytes, size_t len) {
+    const unsigned char* byte = bytes;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= byte[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
 
-    // check if files exist
-    if (stat(outFileName, &outFileStat) == -1 ||
-            stat(errFileName, &errFileStat) == -1 ||
-            stat(statusFileName, &statusFileStat) == -1) {
-        data.regen = true;
+/* hash_file()
+* −----------------
+* Adds the contents of a file to a 64-bit FNV-1a hash
+*
+* hash: The hash so far
+* fileName: The name of the file
+*
+* Returns: the updated hash, unchanged if the file can't be read
+*/
+uint64_t hash_file(uint64_t hash, const char* fileName) {
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1) {
+        return hash;
+    }
+    char chunk[CHUNK_SIZE];
+    ssize_t got;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0) {
+        hash = hash_bytes(hash, chunk, got);
     }
+    close(fd);
+    return hash;
+}
 
-    // check if jobSpecStat is older than any of the files
-    if (compare_timespecs(jobSpecStat.st_mtim, statusFileStat.st_mtim) > 0 ||
-            compare_timespecs(jobSpecStat.st_mtim, outFileStat.st_mtim) > 0 ||
-            compare_timespecs(jobSpecStat.st_mtim, errFileStat.st_mtim) > 0) {
-        data.regen = true;
+/* hash_file_once()
+* −----------------
+* Adds the hash of the contents of a regular file to a 64-bit FNV-1a hash
+* Each file is only read the first time it is hashed, as found by its
+* device and inode, and its hash is reused after that
+*
+* hash: The hash so far
+* fileName: The name of the file
+* seen: The hashes of the files read so far, added to
+*
+* Returns: the updated hash, unchanged if the file isn't a regular file
+*/
+uint64_t hash_file_once(uint64_t hash, const char* fileName, 
+        FileHashes* seen) {
+    struct stat info;
+    if (stat(fileName, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return hash;
     }
+    int i = 0;
+    while (i < seen->numFiles && (seen->files[i].dev != info.st_dev ||
+            seen->files[i].ino != info.st_ino)) {
+        i++;
+    }
+    if (i == seen->numFiles) {
+        seen->files = realloc(seen->files, 
+                (seen->numFiles + 1) * sizeof(FileHash));
+        seen->files[i] = (FileHash) { .dev = info.st_dev, 
+            .ino = info.st_ino, .hash = hash_file(FNV_OFFSET, fileName)};
+        seen->numFiles++;
+    }
+    return hash_bytes(hash, &seen->files[i].hash, sizeof(uint64_t));
+}
 
-    return data;
+/* hash_good_prog()
+* −----------------
+* Hashes the good-uqwordladder program that would be run, found on PATH
+* the same way execvp finds it
+*
+* Returns: the hash of the program, or of nothing if it isn't found
+*/
+uint64_t hash_good_prog(void) {
+    char* path = getenv("PATH");
+    if (!path) {
+        return FNV_OFFSET;
+    }
+    char* dirs = strdup(path);
+    uint64_t hash = FNV_OFFSET;
+    char* save;
+    for (char* dir = strtok_r(dirs, ":", &save); dir;
+            dir = strtok_r(NULL, ":", &save)) {
+        char progName[strlen(dir) + strlen(GOOD_PROG) + 2];
+        sprintf(progName, "%s/%s", dir, GOOD_PROG);
+        if (access(progName, X_OK) == 0) {
+            hash = hash_file(hash, progName);
+            break;
+        }
+    }
+    free(dirs);
+    return hash;
 }
 
-/* generate_output()
+/* hash_job()
 * −----------------
-* Generates the expected output for the test jobs
+* Hashes what the expected output of a test job is generated from: its
+* arguments, the contents of its input file and the reference program
+* Any argument naming a regular file, such as the file after --dict, has
+* its contents hashed too, so editing that file regenerates the job
+* Without --dict the default dictionary the program reads is hashed
+*
+* curJob: The test job
+* progHash: The hash of the good-uqwordladder program
+* seen: The hashes of the files read so far this run
+*
+* Returns: the hash of the test job, never 0
+*/
+uint64_t hash_job(Job curJob, uint64_t progHash, FileHashes* seen) {
+    uint64_t hash = hash_bytes(FNV_OFFSET, &progHash, sizeof(progHash));
+    bool givenDict = false;
+    for (int i = 0; i < curJob.numArgs - 2; i++) {
+        // include the '\0' so where arguments split changes the hash
+        hash = hash_bytes(hash, curJob.givenArgs[i],
+                strlen(curJob.givenArgs[i]) + 1);
+        hash = hash_file_once(hash, curJob.givenArgs[i], seen);
+        if (strcmp(curJob.givenArgs[i], DICT_ARG) == 0 && 
+                i + 1 < curJob.numArgs - 2) {
+            givenDict = true;
+        }
+    }
+    if (!givenDict) {
+        hash = hash_file_once(hash, DEF_DICT, seen);
+    }
+    hash = hash_file_once(hash, curJob.inFileName, seen);
+    return hash ? hash : 1;
+}
+
+/* find_job()
+* −----------------
+* Finds the test job with the given testId
+* The manifest is written in job file order, so the expected index is
+* checked first
 *
 * data: Struct containing all the data for the program.
+* testId: The testId to look for
+* expected: The index the test job is most likely at
 *
-* Returns: updated data struct
+* Returns: the index of the test job, -1 if there isn't one
 */
-Data generate_output(Data data) {
-    data = make_jobdir(data);
-    // iterate over test job and need 3 expected output
+int find_job(Data data, const char* testId, int expected) {
+    if (expected < data.alljobs.numJobs &&
+            strcmp(data.alljobs.jobs[expected].testId, testId) == 0) {
+        return expected;
+    }
     for (int i = 0; i < data.alljobs.numJobs; i++) {
-        Job curJob = data.alljobs.jobs[i];
-        char* modArgs[curJob.numArgs];
-        modArgs[0] = GOOD_PROG; 
-        int buffer = strlen(data.jobdir) + strlen(curJob.testId);
-        for (int j = 0; j < curJob.numArgs - 2; j++) {
-            modArgs[j + 1] = curJob.givenArgs[j];
+        if (strcmp(data.alljobs.jobs[i].testId, testId) == 0) {
+            return i;
         }
-        modArgs[curJob.numArgs - 1] = NULL;
+    }
+    return -1;
+}
 
-        char errFileName[buffer + 9]; // +9 = strlen("/.stderr\0")
-        sprintf(errFileName, STDERR_FILE, data.jobdir, curJob.testId);
+/* read_manifest()
+* −----------------
+* Reads the manifest of the job directory and hashes each test job
+* Each line of the manifest is a testId and a hash, separated by a tab
+* A missing manifest or line just means the job has no hash recorded
+*
+* data: Struct containing all the data for the program.
+*
+* Returns: the manifest
+*/
+Manifest read_manifest(Data data) {
+    int numJobs = data.alljobs.numJobs;
+    Manifest manifest = { .recorded = calloc(numJobs, sizeof(uint64_t)),
+        .current = malloc(numJobs * sizeof(uint64_t)),
+        .upToDate = calloc(numJobs, sizeof(bool))};
+    uint64_t progHash = hash_good_prog();
+    FileHashes seen = { .numFiles = 0, .files = NULL};
+    for (int i = 0; i < numJobs; i++) {
+        manifest.current[i] = hash_job(data.alljobs.jobs[i], progHash, 
+                &seen);
+    }
+    free(seen.files);
+    char manifestName[strlen(data.jobdir) + 10]; // +10 = "/manifest\0"
+    sprintf(manifestName, MANIFEST_FILE, data.jobdir);
+    int manifestFd = open(manifestName, O_RDONLY);
+    if (manifestFd == -1) {
+        return manifest;
+    }
+    LineReader manifestFile;
+    open_reader(&manifestFile, manifestFd);
+    char* line;
+    int lineNum = 0;
+    while ((line = next_line(&manifestFile)) != NULL) {
+        char* tab = strrchr(line, '\t');
+        if (tab) {
+            *tab = '\0';
+            int job = find_job(data, line, lineNum);
+            if (job != -1) {
+                manifest.recorded[job] = strtoull(tab + 1, NULL, 16);
+            }
+        }
+        lineNum++;
+    }
+    close_reader(&manifestFile);
+    close(manifestFd);
+    return manifest;
+}
 
-        char statusFileName[buffer + 13]; // +13 = strlen("/.exitstatus\0")
-        sprintf(statusFileName, EXIT_STAT_FILE, data.jobdir, 
-                curJob.testId);
+/* write_manifest()
+* −----------------
+* Writes the hashes of the test jobs with up to date expected output to
+* the manifest of the job directory
+* It is written to a temporary file and renamed into place
+*
+* data: Struct containing all the data for the program.
+* manifest: The manifest
+*/
+void write_manifest(Data data, Manifest manifest) {
+    char manifestName[strlen(data.jobdir) + 10]; // +10 = "/manifest\0"
+    sprintf(manifestName, MANIFEST_FILE, data.jobdir);
+    char tempName[sizeof(manifestName) + strlen(TEMP_SUFFIX)];
+    sprintf(tempName, "%s%s", manifestName, TEMP_SUFFIX);
+    FILE* manifestFile = fopen(tempName, "w");
+    if (!manifestFile) {
+        return; // jobs will just be regenerated next time
+    }
+    for (int i = 0; i < data.alljobs.numJobs; i++) {
+        if (manifest.upToDate[i]) {
+            fprintf(manifestFile, MANIFEST_LINE,
+                    data.alljobs.jobs[i].testId, manifest.current[i]);
+        }
+    }
+    if (fclose(manifestFile) == 0) {
+        rename(tempName, manifestName);
+    } else {
+        unlink(tempName);
+    }
+}
 
-        char outFileName[buffer + 9]; // +9 = strlen("/.stdout\0")
-        sprintf(outFileName, STDOUT_FILE, data.jobdir, curJob.testId);
+/* check_regen()
+* −----------------
+* Checks to see if the expected output files of a test job need to be
+* regenerated: if --regenerate was given, if any are missing, or if the
+* job's args, input file or the reference program changed since they were
+* generated
+*
+* data: Struct containing all the data for the program.
+* manifest: The manifest of the job directory
+* jobIndex: The index of the test job
+*
+* Returns: true if the expected output needs to be regenerated
+*/
+bool check_regen(Data data, Manifest manifest, int jobIndex) {
+    if (data.regen || manifest.recorded[jobIndex] !=
+            manifest.current[jobIndex]) {
+        return true;
+    }
+    char* formats[] = {STDOUT_FILE, STDERR_FILE, EXIT_STAT_FILE};
+    bool missing = false;
+    for (int i = 0; i < 3 && !missing; i++) {
+        char* fileName = expected_file(formats[i], data,
+                data.alljobs.jobs[jobIndex].testId, false);
+        missing = access(fileName, F_OK) != 0;
+        free(fileName);
+    }
+    return missing;
+}
 
-        data = check_regen(data, outFileName, errFileName, statusFileName);
-        if (data.regen) {
-            open_files(curJob.inFileName, outFileName, errFileName, 
-                    statusFileName, modArgs, curJob.testId);
+/* wait_regen()
+* −----------------
+* Waits for a regeneration to finish and finishes it
+* Returns early if interrupted by SIGINT
+*
+* data: Struct containing all the data for the program.
+* regens: The regenerations, one per worker
+* manifest: The manifest of the job directory
+*
+* Returns: the number of regenerations finished (0 or 1)
+*/
+int wait_regen(Data data, RegenRun* regens, Manifest manifest) {
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    for (int i = 0; i < data.numWorkers && pid > 0; i++) {
+        if (regens[i].pid == pid) {
+            finish_regen(data, regens, i, status, manifest);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* generate_output()
+* −----------------
+* Generates the expected output for the test jobs whose expected output
+* is missing or out of date, as recorded in the manifest
+* Up to numWorkers test jobs are regenerated at once, and each expected
+* output file is written to a temporary file that is renamed into place
+* once it is complete
+* If the program is interrupted, the regenerations in progress are killed
+* and their temporary files removed
+*
+* data: Struct containing all the data for the program.
+*
+* Returns: updated data struct
+*/
+Data generate_output(Data data) {
+    data = make_jobdir(data);
+    RegenRun* regens = calloc(data.numWorkers, sizeof(RegenRun));
+    Manifest manifest = read_manifest(data);
+    int running = 0;
+    // iterate over test job and need 3 expected output
+    for (int i = 0; i < data.alljobs.numJobs && !interrupted; i++) {
+        if (!check_regen(data, manifest, i)) {
+            manifest.upToDate[i] = true;
+            continue;
+        }
+        while (running == data.numWorkers && !interrupted) {
+            running -= wait_regen(data, regens, manifest);
+        }
+        for (int j = 0; j < data.numWorkers && !interrupted; j++) {
+            if (!regens[j].pid) {
+                start_regen(data, i, regens, j);
+                running++;
+                break;
+            }
         }
     }
+    while (running > 0 && !interrupted) {
+        running -= wait_regen(data, regens, manifest);
+    }
+    abort_regen(data, regens);
+    free(regens);
+    write_manifest(data, manifest);
+    free(manifest.recorded);
+    free(manifest.current);
+    free(manifest.upToDate);
     return data;
 }
 
@@ -533,6 +1045,9 @@ pid_t run_prog_child(Data data, Job curJob, int* cmpOutPipe,
         close(cmpOutPipe[READ_END]);
         close(cmpErrPipe[READ_END]);
         int inFile = open(curJob.inFileName, O_RDONLY);
+        if (inFile == -1) {
+            exit(99); // never read the terminal in place of the input
+        }
         dup2(inFile, STDIN_FILENO);
         close(inFile);
         dup2(cmpOutPipe[WRITE_END], STDOUT_FILENO);
@@ -551,88 +1066,14 @@ pid_t run_prog_child(Data data, Job curJob, int* cmpOutPipe,
     return pid;
 }
 
-/* run_cmp_out_child()
-* −----------------
-* Runs the cmp command to compare the stdout of the program with the expected
-* output
-* Redirects stdin to the cmpOutPipe
-* Redirects stdout and stderr to /dev/null
-*
-* data: Struct containing all the data for the program.
-* curJob: The current job that is being run
-* cmpOutPipe: The pipe for the stdout comparison
-* cmpErrPipe: The pipe for the stderr comparison
-*
-* Returns: pid of the child process
-* Errors: if the execvp fails
-*/
-pid_t run_cmp_out_child(Data data, Job curJob, int* cmpOutPipe, 
-        int* cmpErrPipe) {
-    pid_t pid = fork();
-    if (!pid) {
-        close(cmpErrPipe[READ_END]);
-        close(cmpErrPipe[WRITE_END]);
-        close(cmpOutPipe[WRITE_END]);
-        dup2(cmpOutPipe[READ_END], STDIN_FILENO);
-        close(cmpOutPipe[READ_END]);
-        int nullFd = open(NULL_FILE, O_WRONLY);
-        dup2(nullFd, STDERR_FILENO);
-        dup2(nullFd, STDOUT_FILENO);
-        close(nullFd);
-        char outFileName[strlen(data.jobdir) + strlen(curJob.testId) + 9];
-        sprintf(outFileName, STDOUT_FILE, data.jobdir, curJob.testId);
-        char* cmpOutArgs[3] = {"cmp", outFileName, NULL};
-        execvp(cmpOutArgs[0], cmpOutArgs);
-        exit(99);
-    }
-    return pid;
-}
-
-/* run_cmp_err_child()
-* −----------------
-* Runs the cmp command to compare the stderr of the program with the expected
-* output
-* Redirects stdin to the cmpErrPipe
-* Redirects stdout and stderr to /dev/null
-*
-* data: Struct containing all the data for the program.
-* curJob: The current job that is being run
-* cmpOutPipe: The pipe for the stdout comparison
-* cmpErrPipe: The pipe for the stderr comparison
-*
-* Returns: pid of the child process
-* Errors: if the execvp fails
-*/
-pid_t run_cmp_err_child(Data data, Job curJob, int* cmpOutPipe, 
-        int* cmpErrPipe) {
-    pid_t pid = fork();
-    if (!pid) {
-        close(cmpOutPipe[READ_END]);
-        close(cmpOutPipe[WRITE_END]);
-        close(cmpErrPipe[WRITE_END]);
-        dup2(cmpErrPipe[READ_END], STDIN_FILENO);
-        close(cmpErrPipe[READ_END]);
-        int nullFd = open(NULL_FILE, O_WRONLY);
-        dup2(nullFd, STDERR_FILENO);
-        dup2(nullFd, STDOUT_FILENO);
-        close(nullFd);
-        char errFileName[strlen(data.jobdir) + strlen(curJob.testId) + 9];
-        sprintf(errFileName, STDERR_FILE, data.jobdir, curJob.testId);
-        char* cmpErrArgs[3] = {"cmp", errFileName, NULL};
-        execvp(cmpErrArgs[0], cmpErrArgs);
-        exit(99);
-    }
-    return pid;
-}
-
 /* report_results()
 * −----------------
 * Reports the results of the test job
 * Reports if the stdout, stderr, and exit status matches or differs
 *
 * statusA: The exit status of the program
-* statusB: The exit status of the cmp command for stdout
-* statusC: The exit status of the cmp command for stderr
+* outMatches: If the stdout of the program matched the expected output
+* errMatches: If the stderr of the program matched the expected output
 * curJob: The current job that is being run
 * data: Struct containing all the data for the program.
 * failed: Flag to determine if the test job failed
@@ -640,22 +1081,21 @@ pid_t run_cmp_err_child(Data data, Job curJob, int* cmpOutPipe,
 *
 * Returns: updated failed flag
 */
-bool report_results(int statusA, int statusB, int statusC, Job curJob, 
-        Data data, bool failed, bool execFailed){
-    if (WEXITSTATUS(statusB) == 99 || WEXITSTATUS(statusC) == 99 || 
-            WEXITSTATUS(statusA) == 99) {
+bool report_results(int statusA, bool outMatches, bool errMatches, 
+        Job curJob, Data data, bool failed, bool execFailed){
+    if (WEXITSTATUS(statusA) == 99) {
         execFailed = true;
         failed = true;
         gen_message(UNABLE_EXEC, curJob);
     }
     if (execFailed == false) {
-        if (WEXITSTATUS(statusB) == 0) {
+        if (outMatches) {
             gen_message(STDOUT_MATCH, curJob);
         } else {
             gen_message(STDOUT_DIFF, curJob);
             failed = true;
         }
-        if (WEXITSTATUS(statusC) == 0) {
+        if (errMatches) {
             gen_message(STDERR_MATCH, curJob);
         } else {
             gen_message(STDERR_DIFF, curJob);
@@ -667,10 +1107,12 @@ bool report_results(int statusA, int statusB, int statusC, Job curJob,
                 strlen(curJob.testId) + 13];
         sprintf(expected, EXIT_STAT_FILE, data.jobdir,
                 curJob.testId);
-        int expectedStatus;
+        int expectedStatus = -1; // differs if the file couldn't be made
         FILE* exitStatusFile = fopen(expected, "r");
-        fscanf(exitStatusFile, "%d", &expectedStatus);
-        fclose(exitStatusFile);
+        if (exitStatusFile) {
+            fscanf(exitStatusFile, "%d", &expectedStatus);
+            fclose(exitStatusFile);
+        }
         if (actual != expectedStatus) {
             gen_message(EXIT_DIFF, curJob);
             failed = true;
@@ -701,20 +1143,14 @@ void over_all_result(int passed, int run) {
 /* check_interrupted()
 * −----------------
 * Checks to see if the program has been interrupted
-* Closes the pipes and exits the program if it has been interrupted
+* Exits the program if it has been interrupted
 *
 * passed: The number of test jobs that passed
 * run: The number of test jobs that ran
-* cmpOutPipe: The pipe for the stdout comparison
-* cmpErrPipe: The pipe for the stderr comparison
+* data: Struct containing all the data for the program.
 */
-void check_interrupted(int passed, int run, int* cmpOutPipe, 
-        int* cmpErrPipe, Data data) {
+void check_interrupted(int passed, int run, Data data) {
     if (interrupted) {
-        close(cmpOutPipe[READ_END]);
-        close(cmpOutPipe[WRITE_END]);
-        close(cmpErrPipe[READ_END]);
-        close(cmpErrPipe[WRITE_END]);
         free_job(data);
         if (interrupted && passed == 0) {
             fprintf(stdout, NO_TESTS);
@@ -725,10 +1161,273 @@ void check_interrupted(int passed, int run, int* cmpOutPipe,
     }
 }
 
+/* open_check()
+* −----------------
+* Sets up the comparison of a pipe with an expected output file
+* The pipe is made non-blocking and the expected file is memory mapped
+* If the expected file can't be opened the output differs, as with cmp
+*
+* check: The comparison to set up
+* fd: The read end of the pipe
+* fileName: The name of the expected output file
+*/
+void open_check(OutputCheck* check, int fd, char* fileName) {
+    check->fd = fd;
+    check->expected = NULL;
+    check->expectedSize = 0;
+    check->matched = 0;
+    check->differs = false;
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    int file = open(fileName, O_RDONLY);
+    struct stat info;
+    if (file == -1 || fstat(file, &info) == -1) {
+        check->differs = true;
+    } else if (info.st_size > 0) {
+        check->expected = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE,
+                file, 0);
+        if (check->expected == MAP_FAILED) {
+            check->expected = NULL;
+            check->differs = true;
+        } else {
+            check->expectedSize = info.st_size;
+        }
+    }
+    if (file != -1) {
+        close(file);
+    }
+}
+
+/* close_check()
+* −----------------
+* Finishes the comparison of a pipe, which is treated as having ended
+* The output matches only if all of the expected output has been read
+*
+* check: The comparison to finish
+*/
+void close_check(OutputCheck* check) {
+    if (check->fd != -1) {
+        close(check->fd);
+        check->fd = -1;
+    }
+    if (check->matched != check->expectedSize) {
+        check->differs = true;
+    }
+    if (check->expected) {
+        munmap(check->expected, check->expectedSize);
+        check->expected = NULL;
+    }
+}
+
+/* read_check()
+* −----------------
+* Reads everything available from a pipe and compares it chunk by chunk
+* with the expected output. Once it differs the rest is read and dropped,
+* so the program isn't blocked writing to the pipe.
+*
+* check: The comparison of the pipe
+*/
+void read_check(OutputCheck* check) {
+    char chunk[CHUNK_SIZE];
+    while (check->fd != -1) {
+        ssize_t got = read(check->fd, chunk, sizeof(chunk));
+        if (got == 0) {
+            close_check(check);
+        } else if (got < 0) {
+            if (errno != EINTR) {
+                return; // nothing more to read yet
+            }
+        } else if (!check->differs) {
+            if (check->matched + got > check->expectedSize || memcmp(chunk,
+                    check->expected + check->matched, got) != 0) {
+                check->differs = true;
+            }
+            check->matched += got;
+        }
+    }
+}
+
+/* start_test()
+* −----------------
+* Starts the program for a test job with its stdout and stderr connected
+* to new pipes, which are compared with the expected output files as they
+* are read, and sets when the test job is to be killed
+* A pidfd is opened for the program so its exit can be polled for
+*
+* data: Struct containing all the data for the program.
+* curJob: The test job to start
+* testRun: Where the state of the test job is stored
+*/
+void start_test(Data data, Job curJob, TestRun* testRun) {
+    int cmpOutPipe[2], cmpErrPipe[2];
+    // create pipes
+    pipe(cmpOutPipe);
+    pipe(cmpErrPipe);
+    testRun->progPid = run_prog_child(data, curJob, cmpOutPipe, cmpErrPipe);
+    close(cmpOutPipe[WRITE_END]);
+    close(cmpErrPipe[WRITE_END]);
+    int buffer = strlen(data.jobdir) + strlen(curJob.testId);
+    char outFileName[buffer + 9]; // +9 = strlen("/.stdout\0")
+    sprintf(outFileName, STDOUT_FILE, data.jobdir, curJob.testId);
+    char errFileName[buffer + 9]; // +9 = strlen("/.stderr\0")
+    sprintf(errFileName, STDERR_FILE, data.jobdir, curJob.testId);
+    open_check(&testRun->out, cmpOutPipe[READ_END], outFileName);
+    open_check(&testRun->err, cmpErrPipe[READ_END], errFileName);
+    testRun->pidfd = syscall(SYS_pidfd_open, testRun->progPid, 0);
+    fcntl(testRun->pidfd, F_SETFD, FD_CLOEXEC);
+    long timeoutNsec = (long)(curJob.timeout * NSEC_PER_SEC);
+    clock_gettime(CLOCK_MONOTONIC, &testRun->deadline);
+    testRun->deadline.tv_sec += timeoutNsec / NSEC_PER_SEC;
+    testRun->deadline.tv_nsec += timeoutNsec % NSEC_PER_SEC;
+    if (testRun->deadline.tv_nsec >= NSEC_PER_SEC) {
+        testRun->deadline.tv_sec++;
+        testRun->deadline.tv_nsec -= NSEC_PER_SEC;
+    }
+    testRun->started = true;
+}
+
+/* update_test()
+* −----------------
+* Reads any output of a test job and reaps the program if it has exited,
+* without blocking
+* If killProg is set, the program is killed and reaped if still running
+* and whatever output has been read is all it gets compared on
+* The test job is finished once the program is reaped and both pipes have
+* been read to the end
+*
+* testRun: The state of the test job
+* killProg: true if the program is to be killed if still running
+*/
+void update_test(TestRun* testRun, bool killProg) {
+    read_check(&testRun->out);
+    read_check(&testRun->err);
+    if (!testRun->exited) {
+        if (killProg) {
+            kill(testRun->progPid, SIGKILL);
+        }
+        if (waitpid(testRun->progPid, &testRun->status, 
+                killProg ? 0 : WNOHANG) == testRun->progPid) {
+            testRun->exited = true;
+            if (testRun->pidfd != -1) {
+                close(testRun->pidfd);
+                testRun->pidfd = -1;
+            }
+        }
+    }
+    if (killProg) {
+        close_check(&testRun->out);
+        close_check(&testRun->err);
+    }
+    testRun->finished = testRun->exited && testRun->out.fd == -1 && 
+            testRun->err.fd == -1;
+}
+
+/* ms_until()
+* −----------------
+* Gets the time left until a deadline, for use as a poll timeout
+*
+* deadline: The deadline
+*
+* Returns: milliseconds until the deadline (rounded up), 0 if passed
+*/
+int ms_until(struct timespec deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long nsec = (long long)(deadline.tv_sec - now.tv_sec) * NSEC_PER_SEC
+            + (deadline.tv_nsec - now.tv_nsec);
+    if (nsec <= 0) {
+        return 0;
+    }
+    return (int)((nsec + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC);
+}
+
+/* add_poll_fd()
+* −----------------
+* Adds a file descriptor to wait on for input or exit, if it is open
+*
+* fds: The array of file descriptors to poll
+* numFds: The number of file descriptors in the array, updated
+* fd: The file descriptor to add
+*/
+void add_poll_fd(struct pollfd* fds, int* numFds, int fd) {
+    if (fd != -1) {
+        fds[*numFds].fd = fd;
+        fds[*numFds].events = POLLIN;
+        (*numFds)++;
+    }
+}
+
+/* wait_for_tests()
+* −----------------
+* Waits until a running test job has output to read, its program exits,
+* the earliest deadline of the running test jobs passes, or SIGINT arrives
+* SIGINT is only unblocked while waiting, so it can't be missed between
+* checking the interrupted flag and starting to wait
+*
+* runs: The state of all test jobs
+* from: The first test job that may still be running
+* to: One past the last test job started
+*/
+void wait_for_tests(TestRun* runs, int from, int to) {
+    struct pollfd fds[(to - from) * FDS_PER_TEST + 1];
+    int numFds = 0;
+    int timeout = -1;
+    bool fallback = false;
+    for (int i = from; i < to; i++) {
+        if (runs[i].finished) {
+            continue;
+        }
+        int left = ms_until(runs[i].deadline);
+        if (timeout == -1 || left < timeout) {
+            timeout = left;
+        }
+        add_poll_fd(fds, &numFds, runs[i].out.fd);
+        add_poll_fd(fds, &numFds, runs[i].err.fd);
+        if (!runs[i].exited && runs[i].pidfd == -1) {
+            fallback = true; // no pidfd, so check back for the exit
+        } else if (!runs[i].exited) {
+            add_poll_fd(fds, &numFds, runs[i].pidfd);
+        }
+    }
+    if (fallback && (timeout == -1 || timeout > POLL_FALLBACK_MS)) {
+        timeout = POLL_FALLBACK_MS;
+    }
+    sigset_t blockInt, waitMask;
+    sigemptyset(&blockInt);
+    sigaddset(&blockInt, SIGINT);
+    sigprocmask(SIG_BLOCK, &blockInt, &waitMask);
+    if (!interrupted) {
+        struct timespec wait = { .tv_sec = timeout / 1000, 
+            .tv_nsec = (timeout % 1000) * NSEC_PER_MSEC };
+        ppoll(fds, numFds, timeout == -1 ? NULL : &wait, &waitMask);
+    }
+    sigprocmask(SIG_SETMASK, &waitMask, NULL);
+}
+
+/* announce_test()
+* −----------------
+* Prints the "Running test" message for a test job once
+*
+* curJob: The test job
+* testRun: The state of the test job
+*/
+void announce_test(Job curJob, TestRun* testRun) {
+    if (!testRun->announced) {
+        gen_message(RUN_TEST, curJob);
+        testRun->announced = true;
+    }
+}
+
 /* run_test_job()
 * −----------------
-* Runs the test jobs
-* Each job has 1.5 seconds to run before it is killed, then reaped
+* Runs the test jobs, keeping up to numWorkers of them running at once
+* Output of the test jobs is compared with the expected output as it is
+* read from their pipes
+* Test jobs are reaped as soon as their program exits and its output
+* ends, and only killed if still running when their timeout is up
+* (1.5 seconds unless given in the job file)
+* Results are reported in job file order, so a job is only reported once 
+* all jobs before it have been
 * Or if the program is interrupted, the test jobs are killed and reaped
 *
 * data: Struct containing all the data for the program.
@@ -736,43 +1435,51 @@ void check_interrupted(int passed, int run, int* cmpOutPipe,
 void run_test_job(Data data) { 
     int passed = 0;
     int run = 0; 
-    for (int i = 0; i < data.alljobs.numJobs; i++) {
-        Job curJob = data.alljobs.jobs[i];
-        gen_message(RUN_TEST, curJob);
-        bool failed = false;
-        bool execFailed = false;
-        int cmpOutPipe[2], cmpErrPipe[2];
-        int statusA, statusB, statusC;
-        // create pipes
-        pipe(cmpOutPipe);
-        pipe(cmpErrPipe);
-        pid_t runProg = run_prog_child(data, curJob, cmpOutPipe, cmpErrPipe);
-        pid_t cmpOut = run_cmp_out_child(data, curJob, cmpOutPipe, cmpErrPipe);
-        pid_t cmpErr = run_cmp_err_child(data, curJob, cmpOutPipe, cmpErrPipe);
-        close(cmpOutPipe[READ_END]);
-        close(cmpOutPipe[WRITE_END]);
-        close(cmpErrPipe[READ_END]);
-        close(cmpErrPipe[WRITE_END]);
-        // wait 1.5 seconds then kill children
-        usleep(1500000);
-        kill(runProg, SIGKILL);
-        kill(cmpOut, SIGKILL);
-        kill(cmpErr, SIGKILL);
-        waitpid(runProg, &statusA, 0);
-        waitpid(cmpOut, &statusB, 0);
-        waitpid(cmpErr, &statusC, 0);
-        check_interrupted(passed, run, cmpOutPipe, cmpErrPipe, data);
-        failed = report_results(statusA, statusB, statusC, curJob, data, 
-                failed, execFailed);
-        run++;
-        if (failed == false) {
-            passed++;
+    int numJobs = data.alljobs.numJobs;
+    TestRun* runs = calloc(numJobs, sizeof(TestRun));
+    int nextStart = 0, nextReport = 0, running = 0;
+    while (nextReport < numJobs && !interrupted) {
+        while (running < data.numWorkers && nextStart < numJobs) {
+            start_test(data, data.alljobs.jobs[nextStart], &runs[nextStart]);
+            nextStart++;
+            running++;
+        }
+        announce_test(data.alljobs.jobs[nextReport], &runs[nextReport]);
+        wait_for_tests(runs, nextReport, nextStart);
+        if (interrupted) {
+            break;
+        }
+        for (int i = nextReport; i < nextStart; i++) {
+            if (!runs[i].finished) {
+                update_test(&runs[i], ms_until(runs[i].deadline) == 0);
+                running -= runs[i].finished;
+            }
+        }
+        while (nextReport < nextStart && runs[nextReport].finished) {
+            Job curJob = data.alljobs.jobs[nextReport];
+            TestRun* done = &runs[nextReport];
+            announce_test(curJob, done);
+            bool failed = report_results(done->status, !done->out.differs,
+                    !done->err.differs, curJob, data, false, false);
+            run++;
+            if (failed == false) {
+                passed++;
+            }
+            nextReport++;
         }
     }
-    if (!interrupted) {
-        free_job(data);
-        over_all_result(passed, run);
+    if (interrupted) {
+        // abort any tests in progress
+        for (int i = nextReport; i < nextStart; i++) {
+            if (!runs[i].finished) {
+                update_test(&runs[i], true);
+            }
+        }
     }
+    free(runs);
+    check_interrupted(passed, run, data);
+    free_job(data);
+    over_all_result(passed, run);
 }
 
 /* main()
@@ -792,7 +1499,7 @@ int main(int argc, char* argv[]) {
     sigaction(SIGINT, &sigIntHandler, NULL);
     
     Data data = { .jobFile = NULL, .program = NULL, .regen = false,
-        .jobdir = NULL};
+        .jobdir = NULL, .numWorkers = 0};
     data = check_command_line(data, argc, argv);
     data.alljobs = read_jobfile(data);
     data = generate_output(data);
@@ -11,8 +11,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <time.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <csse2310a1.h>
+#include "linereader.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
 
 // constants
 #define MAX_LENGTH 9
@@ -21,7 +34,14 @@
 #define MAX_STEP 40
 #define DEF_STEP 13
 #define GAVE_UP_CODE 19
-#define MAX_WORD 50
+#define READ_CHUNK 65536
+#define ARENA_BLOCK_SIZE 65536
+#define ARENA_ALIGN 16
+#define CACHE_MAGIC "UQWLDIC"
+#define CACHE_VERSION 4
+#define CACHE_ALIGN 8
+#define CACHE_NAME "%s/%08x-%u.dict"
+#define CACHE_TEMP_NAME "%s.%d.tmp"
 #define STEP_ERROR_CODE 13
 #define FILE_ERROR_CODE 1
 #define WORD_LEN_ERROR_CODE 15
@@ -29,7 +49,29 @@
 #define USAGE_ERROR_CODE 11
 #define WORD_ERROR_CODE 10
 #define WORD_SAME_CODE 4
+#define NO_LADDER_CODE 3
+#define GAME_OVER_CODE 12
+#define BATCH_CHUNK 256
+#define DIST_CHUNK 64
+#define DIST_MAGIC "UQWLDST"
+#define DIST_VERSION 1
+#define DIST_FAR 255
+#define MAX_REDRAWS 100
+#define BENCH_DICT "/tmp/uqwordladder-bench-XXXXXX"
+#define BENCH_SEED 0x2545F4914F6CDD1Dull
+#define BENCH_ALPHABET 8
+#define BENCH_BATCH 1000
+#define BENCH_MAX_LOADS 10
 #define DEF_DICT "/usr/share/dict/words"
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+#define FNV64_OFFSET 14695981039346656037ull
+#define FNV64_PRIME 1099511628211ull
+#define HASH_LOAD_FACTOR 2
+#define KEY_MULTIPLIER 0x9E3779B97F4A7C15ull
+#define LETTER_BITS 5
+#define LETTER_MASK 0x1F
+#define LANE_LOW_BITS 0x0000010842108421ull
 #define LENGTH_CONFLICT "uqwordladder: Word length conflict - lengths must be\
  consistent"
 #define WORD_LEN_ERROR "uqwordladder: Word length should be between 2 and 9\
@@ -50,6 +92,117 @@ Your goal is to turn '%s' into '%s' in at most %d steps\n"
 #define NO_PREVIOUS "You can't return to a previous word - try again."
 #define NOT_IN_DICT "Word not found in dictionary - try again."
 #define GAME_OVER "Game over - no more steps remaining."
+#define LADDER_FOUND "Shortest ladder from '%s' to '%s' is %d steps:\n"
+#define NO_LADDER "No ladder from '%s' to '%s' in at most %d steps\n"
+#define LADDERS_FOUND "%" PRIu64 " shortest ladders from '%s' to '%s' of \
+%d steps:\n"
+#define LADDERS_MORE " ... and %" PRIu64 " more\n"
+#define HOPELESS_WARNING "Warning: '%s' is more than %d steps from '%s'.\n"
+#define HOPELESS_OVER "Game over - '%s' is more than %d steps from '%s'.\n"
+#define HINTS_MORE " ... and %d more\n"
+#define BATCH_RESULT "%lu %s %d %d\n"
+#define BATCH_SOLVED "solved"
+#define BATCH_OUT_OF_STEPS "out-of-steps"
+#define BATCH_GAVE_UP "gave-up"
+#define BATCH_INVALID "invalid"
+#define OPTIMAL_STEPS "Optimal: %d steps\n"
+#define OPTIMAL_NONE "Optimal: no ladder\n"
+#define OPTIMAL_AT_LEAST "Optimal: at least %d steps\n"
+#define GRAPH_STATS "words: %d\nedges: %ld\ncomponents: %d\n\
+largest component: %d\nisolated words: %d\n\
+degree: min %d, max %d, mean %.2f\n"
+#define BENCH_DICT_INFO ", \"wordLen\": %u, \"words\": %d, \"bytes\": %zu,\n\
+\"benchmarks\": [\n"
+#define BENCH_RESULT "{\"name\": \"%s\", \"samples\": %d, \
+\"opsPerSample\": %d, \"unit\": \"ns/op\", \"min\": %.1f, \"p50\": %.1f, \
+\"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f, \"mean\": %.1f, \
+\"opsPerSec\": %.0f"
+#define BENCH_THROUGHPUT ", \"mbPerSec\": %.1f, \"wordsPerSec\": %.0f"
+#define BENCH_EMPTY "uqwordladder: No words of that length to benchmark\n"
+#define FILE_NOT_WRITING "uqwordladder: File \"%s\" cannot be written\n"
+
+/*Header at the start of a dictionary cache file, followed by the path of
+the dictionary and then each CacheSection, all padded to CACHE_ALIGN*/
+typedef struct {
+    char magic[8]; //CACHE_MAGIC
+    uint32_t version; //CACHE_VERSION when the file was written
+    uint32_t wordLen; //length of every word in the file
+    int64_t dictMtimeSec; //modification time of the dictionary
+    int64_t dictMtimeNsec;
+    int64_t dictSize; //size in bytes of the dictionary
+    uint64_t bodyHash; //hash_cache_body() of the sections
+    uint32_t pathLen; //length of the dictionary path
+    uint32_t wordsInDict; //number of words in the file
+    uint32_t numComponents; //number of components of the words
+    uint32_t numBuckets; //number of wildcard buckets
+    uint32_t numEdges; //length of the word graph's adjIds
+    uint32_t padding; //0, so no byte of the header is left unset
+} CacheHeader;
+
+/*Arrays stored in a dictionary cache file, in file order. Each is an
+array of Data, and none hold pointers, so they can be used where mapped.*/
+typedef enum {
+    CACHE_WORDS, //filteredDict
+    CACHE_COMPONENTS, //componentOf
+    CACHE_DICT_HASH, //dictHash
+    CACHE_DICT_HASH_IDS, //dictHashIds
+    CACHE_BUCKET_KEYS, //bucketKeys
+    CACHE_BUCKET_OF_SLOT, //bucketOfSlot
+    CACHE_BUCKET_START, //bucketStart
+    CACHE_BUCKET_WORDS, //bucketWords
+    CACHE_PACKED, //packedDict
+    CACHE_ADJ_START, //adjStart
+    CACHE_ADJ_IDS, //adjIds
+    CACHE_SECTIONS //number of sections
+} CacheSection;
+
+/*Block of memory that arena allocations are carved from, newest first*/
+typedef struct ArenaBlock {
+    struct ArenaBlock* prev; //block allocated before this one
+    size_t size; //usable bytes in mem
+    size_t used; //bytes of mem handed out
+    char mem[]; //the memory, ARENA_ALIGN aligned
+} ArenaBlock;
+
+/*Bump allocator owning all the game's strings and arrays, released at once*/
+typedef struct {
+    ArenaBlock* head; //block allocations are currently taken from
+} Arena;
+
+/*Position in an arena that later allocations can be released back to*/
+typedef struct {
+    ArenaBlock* block;
+    size_t used;
+} ArenaMark;
+
+/*Header at the start of a distance table file. It is followed by the
+component of each word and its index within the component (uint32 each),
+the offset of each component's table (uint64, one extra), the size of each
+component (uint32), then each component's table of uint8 distances*/
+typedef struct {
+    char magic[8]; //DIST_MAGIC
+    uint32_t version; //DIST_VERSION when the file was written
+    uint32_t wordLen; //length of every word in the dictionary
+    uint32_t wordsInDict; //number of words in the dictionary
+    uint32_t numComponents; //number of connected components
+    uint32_t dictHash; //hash of the dictionary words it was built from
+    uint32_t padding;
+} DistHeader;
+
+/*Search used to find shortest ladders*/
+typedef enum {
+    SOLVE_BFS, //breadth first search from both ends, the default
+    SOLVE_ASTAR, //A* search guided by the letters left to change
+    SOLVE_IDASTAR, //iterative deepening A*, for little memory
+    SOLVE_UNKNOWN //not the name of a search
+} SolveAlgo;
+
+/*What to do when a move leaves no ladder within the steps left*/
+typedef enum {
+    HOPELESS_IGNORE, //carry on as normal, the default
+    HOPELESS_WARN, //tell the player, then carry on
+    HOPELESS_END //end the game
+} HopelessMode;
 
 /*Infomation need for the game*/
 typedef struct {
@@ -63,16 +216,257 @@ typedef struct {
     bool stepLimSet; //if step limit is set
     bool initWordSet; //if initial word is set
     bool toWordSet; //if target word is set
+    bool solve; //if a shortest ladder should be printed instead of playing
+    SolveAlgo solveAlgo; //search used to find shortest ladders
+    bool listLadders; //if every shortest ladder should be listed
+    long ladderLimit; //most shortest ladders to list, -1 for all of them
+    HopelessMode hopeless; //what to do when the target can't be reached
+    bool rankHints; //if suggestions closest to the target come first
+    int hintLimit; //most suggestions to print, 0 for all of them
+    uint8_t* toTarget; //steps from each word to the target, NULL if unused
+    bool solveAlgoSet; //if the search is set
+    char* batchFile; //file of scripted games to replay, NULL if unset
+    int numThreads; //threads for batch games or distances, 0 if unset
+    char* distBuildFile; //file to write the distance table to, or NULL
+    char* distFile; //distance table to print the optimal steps from, or NULL
+    bool graphStats; //if statistics of the word graph should be printed
+    int benchSamples; //samples per benchmark, 0 if not benchmarking
+    long benchWords; //words in a synthetic benchmark dictionary, or 0
+    char* benchDict; //synthetic dictionary removed on exit, NULL if none
     int wordsInDict; //number of words in dictionary
-    char** filteredDict; //stored array of words from dictionary
+    char* filteredDict; //dictionary words, each wordLen + 1 chars apart
+    char* dictCacheDir; //directory of dictionary cache files, NULL if unset
+    Arena* arena; //owns every string and array below, bar the cache map
+    char* cacheMap; //mapped cache file holding the arrays, NULL if none
+    size_t cacheMapSize; //size of the mapped cache file
     char** givenWords; //stored array of words given by user
+    uint8_t* visited; //bit per dictionary word set once it is on the ladder
     int attempt; //number of attempts user has made
     int sugWordsLen; //number of words user can make
     char** sugWords; //array of suggested words user can make
+    unsigned int dictHashSize; //number of slots in the dictionary hash set
+    char* dictHash; //hash set slots, each packed to wordLen letters
+    int* dictHashIds; //dictionary index of the word in each hash set slot
+    unsigned int bucketHashSize; //number of slots in the bucket hash table
+    uint64_t* bucketKeys; //wildcard pattern key in each slot, 0 if empty
+    int* bucketOfSlot; //bucket number of the key in each slot
+    int numBuckets; //number of wildcard buckets
+    int* bucketStart; //start of each bucket in bucketWords (numBuckets + 1)
+    int* bucketWords; //dictionary indexes grouped by wildcard pattern
+    uint64_t* packedDict; //dictionary words packed 5 bits per letter
+    int* adjStart; //start of each word's neighbours, NULL until needed
+    int* adjIds; //neighbours of every word, each word's in bucket order
+    uint32_t* componentOf; //connected component of each dictionary word
+    int numComponents; //number of connected components
 } Data;
 
+/*Outcome of applying one word to the game*/
+typedef enum {
+    MOVE_ACCEPTED, //word added to the ladder
+    MOVE_SOLVED, //word was the target word
+    MOVE_OUT_OF_STEPS, //valid word, but the step limit was reached
+    MOVE_BAD_LENGTH, //rejected: wrong number of characters
+    MOVE_NOT_LETTERS, //rejected: contains non-letters
+    MOVE_NOT_ONE_DIFF, //rejected: doesn't differ by exactly one letter
+    MOVE_PREVIOUS, //rejected: word already on the ladder
+    MOVE_NOT_IN_DICT //rejected: word not in the dictionary
+} MoveResult;
+
+/*Word in the A* open set, ordered by estimate then by most steps taken*/
+typedef struct {
+    uint8_t estimate; //steps taken plus letters left to change
+    uint8_t steps; //steps taken to reach the word
+    int word; //dictionary index of the word
+} OpenEntry;
+
+/*State of an IDA* search, shared by every level of its recursion*/
+typedef struct {
+    uint64_t goal; //packed target word
+    int target; //dictionary index of the target word
+    int start; //dictionary index of the initial word, -1 if it isn't one
+    int bound; //highest estimate a word may be expanded with
+    int* path; //dictionary indexes of the words on the ladder so far
+    uint8_t* bestSteps; //fewest steps each word was expanded at, or UINT8_MAX
+} DeepeningSearch;
+
+/*Walk through the shortest ladders between two words, one at a time.
+Every word on one is a step closer to the target than the word before*/
+typedef struct {
+    uint8_t* toTarget; //steps from each word to the target, or UINT8_MAX
+    int steps; //steps in each shortest ladder, -1 once there are no more
+    int* first; //dictionary indexes of the initial word's neighbours
+    int numFirst; //number of neighbours of the initial word
+    int* path; //words of the current ladder after the initial word
+    int depth; //step of the path being chosen, -1 before the first ladder
+} LadderWalk;
+
+/*One game of a batch file and its result once played*/
+typedef struct {
+    char* record; //line of the batch file, null terminated
+    unsigned long lineNum; //line number in the batch file
+    const char* outcome; //one of the BATCH_ strings
+    int steps; //steps taken
+    int rejected; //moves rejected
+} BatchGame;
+
+/*Chunks of batch games still to be played by one worker. The owner takes
+chunks from the front, other workers steal them from the back.*/
+typedef struct {
+    pthread_mutex_t lock;
+    int next; //first chunk not yet taken
+    int end; //one past the last chunk not yet stolen
+} BatchQueue;
+
+/*Everything a batch worker thread needs*/
+typedef struct {
+    Data* data; //dictionary and settings, shared read only
+    BatchGame* games; //all games, each written by the worker that plays it
+    int numGames;
+    BatchQueue* queues; //one per worker
+    int numWorkers;
+    int self; //index of this worker's queue
+} BatchWorker;
+
+/*Shortest ladder length between every pair of words in each connected
+component of the dictionary, as laid out in a distance table file*/
+typedef struct {
+    uint32_t numComponents;
+    uint32_t* componentOf; //component of each word, as in Data
+    uint32_t* localIndex; //index of each word within its component
+    uint64_t* offsets; //start of each component's table (numComponents + 1)
+    uint32_t* sizes; //number of words in each component
+    uint8_t* distances; //each component's table, a row per word
+} DistTable;
+
+/*Everything a distance worker thread needs*/
+typedef struct {
+    Data* data; //dictionary, shared read only
+    DistTable* table; //each row written by the worker searching from it
+    BatchQueue* queue; //chunks of source words, shared by all workers
+} DistWorker;
+
 // functions
 
+/* arena_create()
+* −−−−−−−−−−−−−−−
+* Creates an empty arena, its first block is allocated on first use
+*
+* Returns: the new arena
+*/
+Arena* arena_create(void) {
+    Arena* arena = (Arena* )malloc(sizeof(Arena));
+    arena->head = NULL;
+    return arena;
+}
+
+/* arena_alloc()
+* −−−−−−−−−−−−−−−
+* Allocates memory from the arena by bumping the current block. A new
+* block is chained on when it is full, big requests get a block to
+* themselves.
+*
+* arena: arena to allocate from
+* size: number of bytes wanted
+*
+* Returns: pointer to size bytes, ARENA_ALIGN aligned
+*/
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock* block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        //malloc is ARENA_ALIGN aligned, so padding the header keeps the
+        //start of the first allocation aligned
+        size_t headerSize = (sizeof(ArenaBlock) + ARENA_ALIGN - 1) 
+                & ~(size_t)(ARENA_ALIGN - 1);
+        block = (ArenaBlock* )malloc(headerSize + blockSize);
+        block->prev = arena->head;
+        block->size = blockSize + headerSize - sizeof(ArenaBlock);
+        block->used = headerSize - sizeof(ArenaBlock);
+        arena->head = block;
+    }
+    void* memory = block->mem + block->used;
+    block->used += size;
+    return memory;
+}
+
+/* arena_calloc()
+* −−−−−−−−−−−−−−−
+* Allocates zeroed memory from the arena
+*
+* arena: arena to allocate from
+* count: number of elements
+* size: size of each element
+*
+* Returns: pointer to count * size zeroed bytes
+*/
+void* arena_calloc(Arena* arena, size_t count, size_t size) {
+    void* memory = arena_alloc(arena, count * size);
+    memset(memory, 0, count * size);
+    return memory;
+}
+
+/* arena_strdup()
+* −−−−−−−−−−−−−−−
+* Copies a string into the arena
+*
+* arena: arena to allocate from
+* string: string to copy
+*
+* Returns: the copy
+*/
+char* arena_strdup(Arena* arena, const char* string) {
+    size_t len = strlen(string) + 1;
+    return (char* )memcpy(arena_alloc(arena, len), string, len);
+}
+
+/* arena_mark()
+* −−−−−−−−−−−−−−−
+* Gets the current position of the arena, to release back to later
+*
+* arena: arena to mark
+*
+* Returns: the position
+*/
+ArenaMark arena_mark(Arena* arena) {
+    ArenaMark mark = {arena->head, arena->head ? arena->head->used : 0};
+    return mark;
+}
+
+/* arena_reset()
+* −−−−−−−−−−−−−−−
+* Releases everything allocated from the arena since the mark was taken
+*
+* arena: arena to reset
+* mark: position from arena_mark()
+*
+* Returns: Nothing
+*/
+void arena_reset(Arena* arena, ArenaMark mark) {
+    while (arena->head != mark.block) {
+        ArenaBlock* prev = arena->head->prev;
+        free(arena->head);
+        arena->head = prev;
+    }
+    if (arena->head != NULL) {
+        arena->head->used = mark.used;
+    }
+}
+
+/* arena_release()
+* −−−−−−−−−−−−−−−
+* Frees the arena and everything allocated from it
+*
+* arena: arena to free
+*
+* Returns: Nothing
+*/
+void arena_release(Arena* arena) {
+    ArenaMark empty = {NULL, 0};
+    arena_reset(arena, empty);
+    free(arena);
+}
+
 /* my_exit()
 * −−−−−−−−−−−−−−−
 * Frees all memory, that was allocated memory, and exits the program.
@@ -82,29 +476,16 @@ typedef struct {
 *
 * Returns: Nothing.
 */
-void my_exit(int exitCode, Data data){
-    free(data.initWord);
-    free(data.toWord);
-    //freeing all memory to avoid memory leaks
-    if (data.wordsInDict > 0) {
-        for (int i = 0; i < data.wordsInDict; i++) {
-            free(data.filteredDict[i]);
-        }
+void my_exit(int exitCode, Data* data){
+    //a synthetic dictionary is never left behind, however the run ends
+    if (data->benchDict != NULL) {
+        unlink(data->benchDict);
     }
-    if (data.attempt > 1) {
-        for (int i = 0; i < data.attempt - 1; i++) {
-            free(data.givenWords[i]);
-        }
-    }
-    if (data.sugWordsLen > 0) { 
-        for (int i = 0; i < data.sugWordsLen; i++) {
-            free(data.sugWords[i]);
-        }
-        
+    //everything but the cache map is in the arena
+    if (data->cacheMap != NULL) {
+        munmap(data->cacheMap, data->cacheMapSize);
     }
-    free(data.sugWords);
-    free(data.filteredDict);
-    free(data.givenWords);
+    arena_release(data->arena);
     exit(exitCode);
 }
 
@@ -118,7 +499,7 @@ void my_exit(int exitCode, Data data){
 *
 * Returns: Nothing.
 */
-void error_exit(char* message, int exitCode, Data data) {
+void error_exit(char* message, int exitCode, Data* data) {
     fprintf(stderr, "%s\n", message);
     my_exit(exitCode, data);
 }
@@ -181,18 +562,18 @@ void make_caps(char* word) {
 * argc: number of arguments given
 * argv[]: arguments given
 *
-* Returns: Updated data
+* Returns: Nothing
 * Errors: Error message prints and exits if invalid length given
 */
-Data check_input_length(Data data, int argc, char* argv[]) {
+void check_input_length(Data* data, int argc, char* argv[]) {
     for (int i = 1; i < argc; i++) {
         //compares to see is --length is a given argument
         if (strcmp(argv[i], "--length") == 0) {
             // (i + 1 < argc) checks if next arg exists
-            if (i + 1 < argc && data.wordLenSet == false 
+            if (i + 1 < argc && data->wordLenSet == false 
                     && atol(argv[i + 1]) > 0 && check_digits(argv[i + 1])) {
-                data.wordLen = atol(argv[i + 1]);
-                data.wordLenSet = true;
+                data->wordLen = atol(argv[i + 1]);
+                data->wordLenSet = true;
                 i++;
             } else {
                 fprintf(stderr, "%s\n", USAGE_ERROR);
@@ -200,32 +581,65 @@ Data check_input_length(Data data, int argc, char* argv[]) {
             }
         }
     }
-    if (data.wordLenSet == false) {
-        data.wordLen = DEF_LENGTH;
+    if (data->wordLenSet == false) {
+        data->wordLen = DEF_LENGTH;
     }
-    return data;
 }
 
 /* malloc_set()
 * −−−−−−−−−−−−−−−
 * −−−−−−−−−−−−−−−
-* Allocates memory and sets variables
+* Creates the arena and sets variables
 *
 * data: Struct containing all the data for the game.
 *
-* Returns: Updated data
+* Returns: Nothing
+*/
+void malloc_set(Data* data){
+    data->arena = arena_create();
+    //given words are set once stepLim is known
+    data->givenWords = NULL;
+    data->filteredDict = NULL;
+    data->cacheMap = NULL;
+    data->cacheMapSize = 0;
+    data->wordsInDict = 0;
+    data->attempt = 1;
+    data->sugWords = NULL;
+    data->sugWordsLen = 0;
+    data->dictHashSize = 0;
+    data->dictHash = NULL;
+    data->dictHashIds = NULL;
+    data->bucketHashSize = 0;
+    data->bucketKeys = NULL;
+    data->bucketOfSlot = NULL;
+    data->numBuckets = 0;
+    data->bucketStart = NULL;
+    data->bucketWords = NULL;
+    data->packedDict = NULL;
+    data->adjStart = NULL;
+    data->adjIds = NULL;
+    data->componentOf = NULL;
+    data->numComponents = 0;
+    data->initWord = NULL;
+    data->toWord = NULL;
+}
+
+/* solve_algo()
+* −−−−−−−−−−−−−−−
+* Finds the search named on the command line
+*
+* name: name given to --solve-algo
+*
+* Returns: the search, SOLVE_UNKNOWN if there is none by that name
 */
-Data malloc_set(Data data){
-    //Cast incase of warning
-    data.givenWords = (char** )malloc(sizeof(char*)); 
-    data.filteredDict = (char** )malloc(sizeof(char*));
-    data.wordsInDict = 0;
-    data.attempt = 1;
-    data.sugWords = (char** )malloc(sizeof(char*));
-    data.sugWordsLen = 0;
-    data.initWord = (char* )malloc(sizeof(char) * (data.wordLen + 1));
-    data.toWord = (char* )malloc(sizeof(char) * (data.wordLen + 1));
-    return data;
+SolveAlgo solve_algo(const char* name) {
+    const char* names[] = {"bfs", "astar", "idastar"};
+    for (int algo = SOLVE_BFS; algo < SOLVE_UNKNOWN; algo++) {
+        if (strcmp(name, names[algo]) == 0) {
+            return algo;
+        }
+    }
+    return SOLVE_UNKNOWN;
 }
 
 /* check_command_line()
@@ -236,45 +650,104 @@ Data malloc_set(Data data){
 * argc: number of arguments given
 * argv[]: arguments given
 *
-* Returns: Updated data
+* Returns: Nothing
 * Errors: Error message prints and exits if invalid commands given
 */
-Data check_command_line(Data data, int argc, char* argv[]) {
-    data = check_input_length(data, argc, argv);
-    //mallocs memory now so easy to free later
-    data = malloc_set(data);
+void check_command_line(Data* data, int argc, char* argv[]) {
+    check_input_length(data, argc, argv);
+    //arena is made now so easy to free later
+    malloc_set(data);
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--init") == 0 && i + 1 < argc 
-                && data.initWordSet == false) {
-            if (strlen(argv[i + 1]) != data.wordLen) {
-                data.initWord = realloc(data.initWord,
-                        sizeof(char) * (strlen(argv[i + 1]) + 1));
-            }
-            strcpy(data.initWord, argv[i + 1]);
-            make_caps(data.initWord);
-            data.initWordSet = true;
+                && data->initWordSet == false) {
+            data->initWord = arena_strdup(data->arena, argv[i + 1]);
+            make_caps(data->initWord);
+            data->initWordSet = true;
             i++;
         } else if (strcmp(argv[i], "--target") == 0 && i + 1 < argc 
-                && data.toWordSet == false) {
-            if (strlen(argv[i + 1]) != data.wordLen) {
-                data.toWord = realloc(data.toWord, 
-                        sizeof(char) * (strlen(argv[i + 1]) + 1));
-            }
-            strcpy(data.toWord, argv[i + 1]);
+                && data->toWordSet == false) {
+            data->toWord = arena_strdup(data->arena, argv[i + 1]);
             //makes all letters uppercase
-            make_caps(data.toWord);
-            data.toWordSet = true;
+            make_caps(data->toWord);
+            data->toWordSet = true;
             i++;
         } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc 
-                && data.stepLimSet == false && atol(argv[i + 1]) > 0 
+                && data->stepLimSet == false && atol(argv[i + 1]) > 0 
                 && check_digits(argv[i + 1])) {
-            data.stepLim = atol(argv[i + 1]);
-            data.stepLimSet = true;
+            data->stepLim = atol(argv[i + 1]);
+            data->stepLimSet = true;
             i++;
         } else if (strcmp(argv[i], "--dict") == 0 && i + 1 < argc 
-                && data.dictSet == false) {
-            data.dict = argv[i + 1];
-            data.dictSet = true;
+                && data->dictSet == false) {
+            data->dict = argv[i + 1];
+            data->dictSet = true;
+            i++;
+        } else if (strcmp(argv[i], "--solve") == 0 && data->solve == false) {
+            data->solve = true;
+        } else if (strcmp(argv[i], "--solve-algo") == 0 && i + 1 < argc
+                && data->solveAlgoSet == false 
+                && solve_algo(argv[i + 1]) != SOLVE_UNKNOWN) {
+            data->solveAlgo = solve_algo(argv[i + 1]);
+            data->solveAlgoSet = true;
+            i++;
+        } else if (strcmp(argv[i], "--hopeless") == 0 && i + 1 < argc
+                && data->hopeless == HOPELESS_IGNORE
+                && (strcmp(argv[i + 1], "warn") == 0 
+                || strcmp(argv[i + 1], "end") == 0)) {
+            data->hopeless = strcmp(argv[i + 1], "warn") == 0 
+                    ? HOPELESS_WARN : HOPELESS_END;
+            i++;
+        } else if (strcmp(argv[i], "--rank-hints") == 0 
+                && data->rankHints == false) {
+            data->rankHints = true;
+        } else if (strcmp(argv[i], "--hint-limit") == 0 && i + 1 < argc
+                && data->hintLimit == 0 && strtol(argv[i + 1], NULL, 10) > 0
+                && check_digits(argv[i + 1])) {
+            //strtol saturates, and any limit past INT_MAX shows them all
+            long limit = strtol(argv[i + 1], NULL, 10);
+            data->hintLimit = limit > INT_MAX ? INT_MAX : limit;
+            i++;
+        } else if (strcmp(argv[i], "--ladders") == 0 && i + 1 < argc
+                && data->listLadders == false 
+                && (strcmp(argv[i + 1], "all") == 0 
+                || (atol(argv[i + 1]) > 0 && check_digits(argv[i + 1])))) {
+            data->ladderLimit = strcmp(argv[i + 1], "all") == 0 ? -1
+                    : atol(argv[i + 1]);
+            data->listLadders = true;
+            i++;
+        } else if (strcmp(argv[i], "--dict-cache") == 0 && i + 1 < argc 
+                && data->dictCacheDir == NULL) {
+            data->dictCacheDir = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc 
+                && data->batchFile == NULL) {
+            data->batchFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc 
+                && data->numThreads == 0 && atol(argv[i + 1]) > 0 
+                && check_digits(argv[i + 1])) {
+            data->numThreads = atol(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--build-distances") == 0 
+                && i + 1 < argc && data->distBuildFile == NULL) {
+            data->distBuildFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--distances") == 0 && i + 1 < argc 
+                && data->distFile == NULL) {
+            data->distFile = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "--graph-stats") == 0 
+                && data->graphStats == false) {
+            data->graphStats = true;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc
+                && data->benchSamples == 0 && atol(argv[i + 1]) > 0 
+                && check_digits(argv[i + 1])) {
+            data->benchSamples = atol(argv[i + 1]);
+            i++;
+        } else if (strcmp(argv[i], "--bench-words") == 0 && i + 1 < argc
+                && data->benchWords == 0 && atol(argv[i + 1]) > 0 
+                && check_digits(argv[i + 1])) {
+            data->benchWords = atol(argv[i + 1]);
             i++;
         } else if (strcmp(argv[i], "--length") == 0) {
             //Do nothing it was checked before
@@ -283,7 +756,24 @@ Data check_command_line(Data data, int argc, char* argv[]) {
             error_exit(USAGE_ERROR, USAGE_ERROR_CODE, data);
         }
     }
-    return data;
+    //batch games bring their own words, building distances, graph
+    //statistics and benchmarks need none, and threads are only for the
+    //first two. Synthetic words stand in for the dictionary when timed.
+    int offline = (data->batchFile != NULL) + (data->distBuildFile != NULL)
+            + (data->graphStats == true) + (data->benchSamples != 0);
+    if (data->benchWords != 0 
+            && (data->benchSamples == 0 || data->dictSet == true)) {
+        error_exit(USAGE_ERROR, USAGE_ERROR_CODE, data);
+    }
+    if ((offline > 0 && (data->initWordSet == true || data->toWordSet == true
+            || data->solve == true || data->solveAlgoSet == true
+            || data->listLadders == true || data->hopeless != HOPELESS_IGNORE
+            || data->rankHints == true || data->hintLimit != 0
+            || data->distFile != NULL))
+            || offline > 1 || (data->numThreads != 0 
+            && data->batchFile == NULL && data->distBuildFile == NULL)) {
+        error_exit(USAGE_ERROR, USAGE_ERROR_CODE, data);
+    }
 }
 
 /* length_check()
@@ -293,38 +783,37 @@ Data check_command_line(Data data, int argc, char* argv[]) {
 *
 * data: Struct containing all the data for the game.
 *
-* Returns: Updated data
+* Returns: Nothing
 * Errors: Error message prints and exits if legnths are inconsistent or not in 
 * valid range
 */
-Data length_check(Data data) {
+void length_check(Data* data) {
     //sets lenght of the word if not specified
-    if (data.wordLenSet == false && data.initWordSet == false 
-            && data.toWordSet == true) {
-        data.wordLen = strlen(data.toWord);
-    } else if (data.wordLenSet == false && data.initWordSet == true 
-            && data.toWordSet == false) {
-        data.wordLen = strlen(data.initWord);
+    if (data->wordLenSet == false && data->initWordSet == false 
+            && data->toWordSet == true) {
+        data->wordLen = strlen(data->toWord);
+    } else if (data->wordLenSet == false && data->initWordSet == true 
+            && data->toWordSet == false) {
+        data->wordLen = strlen(data->initWord);
     }
     //checks if the length of the words are the same
-    if (data.initWordSet == true){
-        if (strlen(data.initWord) != data.wordLen) {
+    if (data->initWordSet == true){
+        if (strlen(data->initWord) != data->wordLen) {
             error_exit(LENGTH_CONFLICT, LENGTH_CONFLICT_CODE, data);
-        } else if (data.toWordSet == true && strlen(data.toWord) 
-                != strlen(data.initWord)) {
+        } else if (data->toWordSet == true && strlen(data->toWord) 
+                != strlen(data->initWord)) {
             error_exit(LENGTH_CONFLICT, LENGTH_CONFLICT_CODE, data);
         }
     } 
-    if (data.toWordSet == true) {
-        if (strlen(data.toWord) != data.wordLen) {
+    if (data->toWordSet == true) {
+        if (strlen(data->toWord) != data->wordLen) {
             error_exit(LENGTH_CONFLICT, LENGTH_CONFLICT_CODE, data);
         }
     } 
     //checks if the word length is in valid range
-    if (data.wordLen < MIN_LENGTH || data.wordLen > MAX_LENGTH) {
+    if (data->wordLen < MIN_LENGTH || data->wordLen > MAX_LENGTH) {
         error_exit(WORD_LEN_ERROR, WORD_LEN_ERROR_CODE, data);
     }
-    return data;
 }
 
 /* word_check()
@@ -333,31 +822,30 @@ Data length_check(Data data) {
 *
 * data: Struct containing all the data for the game.
 *
-* Returns: Updated data
+* Returns: Nothing
 * Errors: Error message prints and exits if initial and target words are same
 */
-Data word_check(Data data) {
-    if (data.initWordSet == true) {
-        if (check_chars(data.initWord) == false) {
+void word_check(Data* data) {
+    if (data->initWordSet == true) {
+        if (check_chars(data->initWord) == false) {
             error_exit(WORD_ERROR, WORD_ERROR_CODE, data);
         }
     } else {
         // stored in a temp variable to avoid same word being pointed to
-        const char* temp = get_uqwordladder_word(data.wordLen);
-        strcpy(data.initWord, temp);
+        const char* temp = get_uqwordladder_word(data->wordLen);
+        data->initWord = arena_strdup(data->arena, temp);
     }
-    if (data.toWordSet == true) {
-        if (check_chars(data.toWord) == false) {
+    if (data->toWordSet == true) {
+        if (check_chars(data->toWord) == false) {
             error_exit(WORD_ERROR, WORD_ERROR_CODE, data);
         }
     } else {
-        const char* temp2 = get_uqwordladder_word(data.wordLen);
-        strcpy(data.toWord, temp2);
+        const char* temp2 = get_uqwordladder_word(data->wordLen);
+        data->toWord = arena_strdup(data->arena, temp2);
     }
-    if (strcasecmp(data.initWord, data.toWord) == 0) {
+    if (strcasecmp(data->initWord, data->toWord) == 0) {
         error_exit(WORD_SAME, WORD_SAME_CODE, data);
     }    
-    return data;
 }
 
 /* step_check()
@@ -366,277 +854,3238 @@ Data word_check(Data data) {
 *
 * data: Struct containing all the data for the game.
 *
-* Returns: Updated data
+* Returns: Nothing
 * Errors: Error message prints and exits if stemp limit out of set range
 */
-Data step_check(Data data) {
-    if (data.stepLimSet == false) {
-        data.stepLim = DEF_STEP;
-    } else if (data.stepLim < data.wordLen || data.stepLim > MAX_STEP) {
+void step_check(Data* data) {
+    if (data->stepLimSet == false) {
+        data->stepLim = DEF_STEP;
+    } else if (data->stepLim < data->wordLen || data->stepLim > MAX_STEP) {
         error_exit(STEP_ERROR, STEP_ERROR_CODE, data);
     }
-    return data;
+    //at most stepLim words can be given, so this never grows
+    data->givenWords = (char** )arena_alloc(data->arena, 
+            sizeof(char*) * data->stepLim);
 }
 
 /* set_false()
 * −−−−−−−−−−−−−−−
-* Sets all the user changable variable bools to false
+* Sets all the user changable variable bools to false, and optional
+* settings to unset
 *
 * data: Struct containing all the data for the game.
 *
-* Returns: Updated data
+* Returns: Nothing
 */
-Data set_false(Data data) {
-    data.dictSet = false;
-    data.wordLenSet = false;
-    data.stepLimSet = false;
-    data.initWordSet = false;
-    data.toWordSet = false;
-    return data;
+void set_false(Data* data) {
+    data->dictSet = false;
+    data->wordLenSet = false;
+    data->stepLimSet = false;
+    data->initWordSet = false;
+    data->toWordSet = false;
+    data->solve = false;
+    data->solveAlgo = SOLVE_BFS;
+    data->solveAlgoSet = false;
+    data->listLadders = false;
+    data->ladderLimit = -1;
+    data->hopeless = HOPELESS_IGNORE;
+    data->rankHints = false;
+    data->hintLimit = 0;
+    data->toTarget = NULL;
+    data->visited = NULL;
+    data->batchFile = NULL;
+    data->numThreads = 0;
+    data->distBuildFile = NULL;
+    data->distFile = NULL;
+    data->graphStats = false;
+    data->benchSamples = 0;
+    data->benchWords = 0;
+    data->benchDict = NULL;
+    data->dictCacheDir = NULL;
 }
 
-/* read_dictionary()
+/* dict_word()
 * −−−−−−−−−−−−−−−
-* Reads the dictionary file and stores all valid length words in an array
+* Gets a word from the dictionary
 *
 * data: Struct containing all the data for the game.
+* index: position of the word in the dictionary
 *
-* Returns: Updated data
-* Errors: Error message prints and exits if unreadable or non-existent
+* Returns: pointer to the null terminated word
+*/
+char* dict_word(Data* data, int index) {
+    return data->filteredDict + (size_t)index * (data->wordLen + 1);
+}
+
+/* hash_word()
+* −−−−−−−−−−−−−−−
+* FNV-1a hash of the first len characters of a word
+*
+* word: given word to hash
+* len: number of characters to hash
+*
+* Returns: hash of the word
 */
-Data read_dictionary(Data data) {
-    if (data.dictSet == false) {
-        data.dict = DEF_DICT;
+uint32_t hash_word(const char* word, unsigned int len) {
+    uint32_t hash = FNV_OFFSET;
+    for (unsigned int i = 0; i < len; i++) {
+        hash ^= (unsigned char)word[i];
+        hash *= FNV_PRIME;
     }
-    FILE* file = fopen(data.dict, "r");
-    if (file == NULL){
-        fprintf(stderr, FILE_NOT_OPENING, data.dict);
-        my_exit(FILE_ERROR_CODE, data);
+    return hash;
+}
+
+/* hash_table_size()
+* −−−−−−−−−−−−−−−
+* Gets the number of slots an open addressing table needs for a number of
+* entries. It is a power of two so the hash can be masked.
+*
+* entries: number of entries the table holds
+*
+* Returns: number of slots
+*/
+unsigned int hash_table_size(long entries) {
+    unsigned int size = 1;
+    while (size < entries * HASH_LOAD_FACTOR) {
+        size <<= 1;
     }
-    char word[MAX_WORD + 1]; // +1 for null terminator
+    return size;
+}
 
-    while (fgets(word, sizeof(char*) * MAX_WORD, file) != NULL) {
-        if (strlen(word) > 0 && word[strlen(word) - 1] == '\n') {
-            word[strlen(word) - 1] = '\0';
+/* build_dict_hash()
+* −−−−−−−−−−−−−−−
+* Builds an open addressing hash set of all words in the dictionary.
+* Each slot holds a word packed to wordLen characters (no terminator) and
+* its dictionary index, an empty slot starts with a null character.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void build_dict_hash(Data* data) {
+    data->dictHashSize = hash_table_size(data->wordsInDict);
+    data->dictHash = (char* )arena_calloc(data->arena, data->dictHashSize, 
+            data->wordLen);
+    data->dictHashIds = (int* )arena_alloc(data->arena, 
+            sizeof(int) * data->dictHashSize);
+    unsigned int mask = data->dictHashSize - 1;
+    for (int i = 0; i < data->wordsInDict; i++) {
+        char* word = dict_word(data, i);
+        unsigned int slot = hash_word(word, data->wordLen) & mask;
+        char* entry = data->dictHash + (size_t)slot * data->wordLen;
+        //linear probe until an empty slot or the same word is found
+        while (entry[0] != '\0' && memcmp(entry, word, data->wordLen) != 0) {
+            slot = (slot + 1) & mask;
+            entry = data->dictHash + (size_t)slot * data->wordLen;
         }
-        if (strlen(word) == data.wordLen && check_chars(word)) {  
-            data.filteredDict = (char**)realloc(data.filteredDict,
-                sizeof(char*) * (data.wordsInDict + 1));
-            make_caps(word);
-            data.filteredDict[data.wordsInDict] = strdup(word);
-            data.wordsInDict++;
+        //a repeated word keeps the index of its first occurrence
+        if (entry[0] == '\0') {
+            memcpy(entry, word, data->wordLen);
+            data->dictHashIds[slot] = i;
         }
     }
-    //closes file
-    fclose(file);
-    return data;
 }
 
-/* print_stdout()
+/* pack_word()
 * −−−−−−−−−−−−−−−
-* Prints message to stdout
+* Packs a word into an integer of 5 bits per letter, the first letter
+* highest. Letters are 1 to 26, anything else can't match a dictionary word.
 *
-* message: Output message
+* word: given word to pack
+* len: length of the word (at most MAX_LENGTH)
 *
-* Returns: Nothing
+* Returns: packed word
 */
-void print_stdout(char* message) {
-    fprintf(stdout, "%s\n", message);
+uint64_t pack_word(const char* word, unsigned int len) {
+    uint64_t packed = 0;
+    for (unsigned int i = 0; i < len; i++) {
+        uint64_t code = isalpha((unsigned char)word[i]) 
+                ? toupper((unsigned char)word[i]) - 'A' + 1 : LETTER_MASK;
+        packed = (packed << LETTER_BITS) | code;
+    }
+    return packed;
 }
 
-/* in_dict()
+/* pattern_key()
 * −−−−−−−−−−−−−−−
-* Check if the given word is in the dictionary
+* Packs a word with the letter at wildPos replaced by a wildcard (0).
+* Words that only differ at wildPos have the same key. e.g. CAT and COT
+* both give the key for C_T.
 *
-* word: given word to check
-* data: Struct containing all the data for the game.
+* word: given word to pack
+* len: length of the word
+* wildPos: position of the wildcard letter
 *
-* Returns: boolean if word in dictionary
+* Returns: packed key of the pattern
 */
-bool in_dict(char* word, Data data) {
-    for (int i = 0; i < data.wordsInDict; i++) {
-        if (strcmp(word, data.filteredDict[i]) == 0) {
-            return true;
+uint64_t pattern_key(const char* word, unsigned int len, unsigned int wildPos) {
+    uint64_t wildcard = (uint64_t)LETTER_MASK 
+            << (LETTER_BITS * (len - 1 - wildPos));
+    return pack_word(word, len) & ~wildcard;
+}
+
+/* packed_one_diff()
+* −−−−−−−−−−−−−−−
+* Check if two packed words differ in exactly one letter. Each letter's 5
+* bits of the xor are folded onto the letter's lowest bit, leaving one bit
+* set per differing letter.
+*
+* word1: packed word to check
+* word2: packed word to check against
+*
+* Returns: boolean the 2 words are only 1 letter different
+*/
+bool packed_one_diff(uint64_t word1, uint64_t word2) {
+    uint64_t x = word1 ^ word2;
+    uint64_t lanes = (x | x >> 1 | x >> 2 | x >> 3 | x >> 4) & LANE_LOW_BITS;
+    return lanes != 0 && (lanes & (lanes - 1)) == 0;
+}
+
+/* packed_distance()
+* −−−−−−−−−−−−−−−
+* Counts the letters two packed words differ in, folding the xor as
+* packed_one_diff() does
+*
+* word1: packed word to check
+* word2: packed word to check against
+*
+* Returns: number of letters that differ
+*/
+int packed_distance(uint64_t word1, uint64_t word2) {
+    uint64_t x = word1 ^ word2;
+    return __builtin_popcountll((x | x >> 1 | x >> 2 | x >> 3 | x >> 4) 
+            & LANE_LOW_BITS);
+}
+
+/* scan_one_diff_scalar()
+* −−−−−−−−−−−−−−−
+* Finds the packed words that differ from the query in exactly one letter
+*
+* query: packed word to compare against
+* packed: array of packed words
+* from: index to start at
+* count: number of packed words in the array
+* matches: set to the indexes found, in order
+*
+* Returns: number of matches found
+*/
+int scan_one_diff_scalar(uint64_t query, const uint64_t* packed, int from,
+        int count, int* matches) {
+    int found = 0;
+    for (int i = from; i < count; i++) {
+        if (packed_one_diff(query, packed[i])) {
+            matches[found++] = i;
         }
     }
-    return false;
+    return found;
 }
 
-/* previous_word()
+#ifdef HAVE_X86_SIMD
+/* scan_one_diff_sse2()
 * −−−−−−−−−−−−−−−
-* Check if the given word was a previous word entered
+* SSE2 version of scan_one_diff_scalar(), testing 4 words per iteration.
+* SSE2 has no 64 bit compare, so the 32 bit halves are compared and then
+* combined with their swapped pair.
 *
-* word: given word to check
-* data: Struct containing all the data for the game.
+* query: packed word to compare against
+* packed: array of packed words
+* count: number of packed words in the array
+* matches: set to the indexes found, in order
 *
-* Returns: boolean if word was previous word
+* Returns: number of matches found
 */
-bool previous_word(Data data, char* word) {
-    for (int i = 0; i < data.attempt - 1; i++) {
-        if (strcmp(word, data.givenWords[i]) == 0) {
-            return true;
+__attribute__((target("sse2")))
+int scan_one_diff_sse2(uint64_t query, const uint64_t* packed, int count,
+        int* matches) {
+    __m128i q = _mm_set1_epi64x(query);
+    __m128i low = _mm_set1_epi64x(LANE_LOW_BITS);
+    __m128i one = _mm_set1_epi64x(1);
+    __m128i zero = _mm_setzero_si128();
+    int found = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int mask = 0;
+        for (int half = 0; half < 2; half++) {
+            __m128i x = _mm_xor_si128(q, _mm_loadu_si128(
+                    (const __m128i*)(packed + i + 2 * half)));
+            x = _mm_or_si128(_mm_or_si128(x, _mm_srli_epi64(x, 1)),
+                    _mm_or_si128(_mm_srli_epi64(x, 2), _mm_or_si128(
+                    _mm_srli_epi64(x, 3), _mm_srli_epi64(x, 4))));
+            __m128i lanes = _mm_and_si128(x, low);
+            __m128i none = _mm_cmpeq_epi32(lanes, zero);
+            none = _mm_and_si128(none, _mm_shuffle_epi32(none, 0xB1));
+            __m128i single = _mm_cmpeq_epi32(_mm_and_si128(lanes, 
+                    _mm_sub_epi64(lanes, one)), zero);
+            single = _mm_and_si128(single, _mm_shuffle_epi32(single, 0xB1));
+            mask |= _mm_movemask_pd(_mm_castsi128_pd(
+                    _mm_andnot_si128(none, single))) << (2 * half);
+        }
+        while (mask != 0) {
+            matches[found++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
         }
     }
-    return false;
+    return found + scan_one_diff_scalar(query, packed, i, count, 
+            matches + found);
 }
 
-/* one_letter_diff()
+/* scan_one_diff_avx2()
 * −−−−−−−−−−−−−−−
-* Check if the given word was a previous word entered
+* AVX2 version of scan_one_diff_scalar(), testing 8 words per iteration
 *
-* word1: given word to check
-* word2: given word to check against
+* query: packed word to compare against
+* packed: array of packed words
+* count: number of packed words in the array
+* matches: set to the indexes found, in order
 *
-* Returns: boolean the 2 words are only 1 letter different
+* Returns: number of matches found
 */
-bool one_letter_diff(char* word1, char* word2) {
-    int diff = 0;
-    for (int i = 0; i < strlen(word1); i++) {
-        if (word1[i] != word2[i]) {
-            diff++;
+__attribute__((target("avx2")))
+int scan_one_diff_avx2(uint64_t query, const uint64_t* packed, int count,
+        int* matches) {
+    __m256i q = _mm256_set1_epi64x(query);
+    __m256i low = _mm256_set1_epi64x(LANE_LOW_BITS);
+    __m256i one = _mm256_set1_epi64x(1);
+    __m256i zero = _mm256_setzero_si256();
+    int found = 0;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int mask = 0;
+        for (int half = 0; half < 2; half++) {
+            __m256i x = _mm256_xor_si256(q, _mm256_loadu_si256(
+                    (const __m256i*)(packed + i + 4 * half)));
+            x = _mm256_or_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 1)),
+                    _mm256_or_si256(_mm256_srli_epi64(x, 2), _mm256_or_si256(
+                    _mm256_srli_epi64(x, 3), _mm256_srli_epi64(x, 4))));
+            __m256i lanes = _mm256_and_si256(x, low);
+            __m256i none = _mm256_cmpeq_epi64(lanes, zero);
+            __m256i single = _mm256_cmpeq_epi64(_mm256_and_si256(lanes,
+                    _mm256_sub_epi64(lanes, one)), zero);
+            mask |= _mm256_movemask_pd(_mm256_castsi256_pd(
+                    _mm256_andnot_si256(none, single))) << (4 * half);
+        }
+        while (mask != 0) {
+            matches[found++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
         }
     }
-    if (diff == 1) {
-        return true;
+    return found + scan_one_diff_scalar(query, packed, i, count, 
+            matches + found);
+}
+#endif
+
+/* scan_one_diff()
+* −−−−−−−−−−−−−−−
+* Finds the packed words that differ from the query in exactly one letter,
+* using the widest vector instructions the CPU supports
+*
+* query: packed word to compare against
+* packed: array of packed words
+* count: number of packed words in the array
+* matches: set to the indexes found, in order. Must have room for count.
+*
+* Returns: number of matches found
+*/
+int scan_one_diff(uint64_t query, const uint64_t* packed, int count,
+        int* matches) {
+#ifdef HAVE_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) {
+        return scan_one_diff_avx2(query, packed, count, matches);
     }
-    return false;
+    if (__builtin_cpu_supports("sse2")) {
+        return scan_one_diff_sse2(query, packed, count, matches);
+    }
+#endif
+    return scan_one_diff_scalar(query, packed, 0, count, matches);
 }
 
-/* print_suggestions()
+/* pack_dictionary()
 * −−−−−−−−−−−−−−−
-* Prints all vaild attempts user can make or no suggestions available
+* Packs every dictionary word 5 bits per letter for the scan kernels
 *
 * data: Struct containing all the data for the game.
-* previous: given word to check against
 *
 * Returns: Nothing
 */
-void print_suggestions(Data data, char* previous) {    
-    //Check if given word is final word
-    if (one_letter_diff(previous, data.toWord) == true) {
-        data.sugWords[data.sugWordsLen] = strdup(data.toWord);
-        data.sugWordsLen++;
-    } 
-    //adds all valid words to array
-    for (int i = 0; i < data.wordsInDict; i++) {
-        if (one_letter_diff(previous, data.filteredDict[i]) == true
-                && previous_word(data, data.filteredDict[i]) == false
-                && strcmp(data.filteredDict[i], data.toWord) != 0
-                && strcmp(data.filteredDict[i], data.initWord) != 0) {
-            data.sugWords = realloc(data.sugWords, 
-                    sizeof(char*) * (data.sugWordsLen + 1));
-            data.sugWords[data.sugWordsLen] = strdup(data.filteredDict[i]);
-            data.sugWordsLen++;
-        }
-    }
-    if (data.sugWordsLen == 0) {
-        print_stdout("No suggestions available.");
-    } else {
-        print_stdout("Suggestions:-----------");
-        for (int i = 0; i < data.sugWordsLen; i++) {
-            fprintf(stdout, " %s\n", data.sugWords[i]);
-        }
-        print_stdout("-----End of Suggestions");
+void pack_dictionary(Data* data) {
+    data->packedDict = (uint64_t* )arena_alloc(data->arena, sizeof(uint64_t) 
+            * (data->wordsInDict + 1));
+    for (int i = 0; i < data->wordsInDict; i++) {
+        data->packedDict[i] = pack_word(dict_word(data, i), data->wordLen);
     }
 }
 
-/* check_input()
+/* find_bucket_slot()
 * −−−−−−−−−−−−−−−
-* Gets user input and checks if it is valid
+* Finds the slot in the bucket hash table holding the given key, or the
+* empty slot where it would be inserted
 *
 * data: Struct containing all the data for the game.
-* input: users input
+* key: wildcard pattern key to look for
 *
-* Returns: Updated data
-* Errors: Message prints and exits if game won or step limit reached 
+* Returns: slot number in the bucket hash table
 */
-Data check_input(char input[MAX_LENGTH + 2], Data data){
-    if (strcmp(input, "?") == 0) {
-        if (data.attempt == 1) {
-            print_suggestions(data, data.initWord);
-        } else {
-            print_suggestions(data, data.givenWords[data.attempt - 2]);
-        }
-    } else if (strlen(input) != data.wordLen) {
-        fprintf(stdout, "Word should have %d characters - try again.\n",
-                data.wordLen);
-    } else if (check_chars(input) == false) {
-        print_stdout(ONLY_LETTERS);
-    } else if (( data.attempt == 1 && one_letter_diff(input, data.initWord) 
-            == false) || (data.attempt > 1 && one_letter_diff(input,
-            data.givenWords[data.attempt - 2]) == false)) { 
-            //-2 cause attempt starts at 1
-        print_stdout(DIFFER_ONE);
-    } else if (strcmp(input, data.initWord) == 0 || 
-            (data.attempt > 1 && previous_word(data, input) == true)) {
-        print_stdout(NO_PREVIOUS);
-    } else if (in_dict(input, data) == false) {
-        print_stdout(NOT_IN_DICT);
-    } else if (strcmp(input, data.toWord) == 0) {
-        fprintf(stdout, "Well done - you solved the ladder in %d steps.\n",
-                data.attempt);
-        my_exit(0, data);
-    } else if (data.attempt == data.stepLim) {
-        print_stdout(GAME_OVER);
-        my_exit(12, data);
-    } else {
-        //increases size of array and adds given valid word to it
-        data.givenWords = (char**)realloc(data.givenWords, 
-                sizeof(char*) * (data.attempt));
-        data.givenWords[data.attempt - 1] = strdup(input);
-        data.attempt++;
+unsigned int find_bucket_slot(Data* data, uint64_t key) {
+    unsigned int mask = data->bucketHashSize - 1;
+    unsigned int slot = (unsigned int)((key * KEY_MULTIPLIER) >> 32) & mask;
+    while (data->bucketKeys[slot] != 0 && data->bucketKeys[slot] != key) {
+        slot = (slot + 1) & mask;
     }
-    return data;
+    return slot;
 }
 
-/* game_loop()
+/* build_buckets()
 * −−−−−−−−−−−−−−−
-* Gets user input and checks if it is valid
+* Groups every dictionary word under each of its wildcard patterns, so the
+* words one letter away from a word can be found from wordLen buckets.
+* Buckets are counted in a first pass, then filled in dictionary order.
 *
 * data: Struct containing all the data for the game.
 *
 * Returns: Nothing
-* Errors: Message prints and exits if exited 
-* REF: Used Chat-GPT to convered my function with fgets, to something with
-* REF: dynamically allocated memory. Which it gave getline.
-* REF: Which was changed to fit styleguide and comments added to show my 
-* REF: understanding of the function.
 */
-void game_loop(Data data) {
-    char* input = NULL; // Initialize input pointer to NULL
-    size_t inputSize = 0; // Initialize inputSize to 0
+void build_buckets(Data* data) {
+    int entries = data->wordsInDict * data->wordLen;
+    data->bucketHashSize = hash_table_size(entries);
+    data->bucketKeys = (uint64_t* )arena_calloc(data->arena, 
+            data->bucketHashSize, sizeof(uint64_t));
+    data->bucketOfSlot = (int* )arena_alloc(data->arena, 
+            sizeof(int) * data->bucketHashSize);
+    //bucket sizes first, one extra so the counts can become start offsets
+    int* counts = (int* )arena_calloc(data->arena, entries + 1, sizeof(int));
+    int numBuckets = 0;
+    for (int i = 0; i < data->wordsInDict; i++) {
+        for (unsigned int pos = 0; pos < data->wordLen; pos++) {
+            uint64_t key = pattern_key(dict_word(data, i), data->wordLen, pos);
+            unsigned int slot = find_bucket_slot(data, key);
+            if (data->bucketKeys[slot] == 0) {
+                data->bucketKeys[slot] = key;
+                data->bucketOfSlot[slot] = numBuckets++;
+            }
+            counts[data->bucketOfSlot[slot] + 1]++;
+        }
+    }
+    for (int b = 0; b < numBuckets; b++) {
+        counts[b + 1] += counts[b];
+    }
+    data->numBuckets = numBuckets;
+    data->bucketStart = counts;
+    data->bucketWords = (int* )arena_alloc(data->arena, 
+            sizeof(int) * (entries + 1));
+    int* fill = (int* )malloc(sizeof(int) * (numBuckets + 1));
+    memcpy(fill, counts, sizeof(int) * (numBuckets + 1));
+    for (int i = 0; i < data->wordsInDict; i++) {
+        for (unsigned int pos = 0; pos < data->wordLen; pos++) {
+            uint64_t key = pattern_key(dict_word(data, i), data->wordLen, pos);
+            int bucket = data->bucketOfSlot[find_bucket_slot(data, key)];
+            data->bucketWords[fill[bucket]++] = i;
+        }
+    }
+    free(fill);
+}
 
-    while (1) {
-        fprintf(stdout, ENTER_WORD, data.attempt);
-        // getline() reads the whole line from stdin.
-        // since input is NULL and inputSize 0
-        // getline will allocate sufficent memory for input
-        if (getline(&input, &inputSize, stdin) == -1) {
-            free(input); // Free the allocated memory
-            print_stdout(GAVE_UP);
-            my_exit(GAVE_UP_CODE, data);
+/* compare_ints()
+* −−−−−−−−−−−−−−−
+* qsort() comparison function for ints in ascending order
+*
+* a: pointer to first int
+* b: pointer to second int
+*
+* Returns: negative, zero or positive as a is less, equal or greater than b
+*/
+int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/* neighbour_buckets()
+* −−−−−−−−−−−−−−−
+* Finds the wildcard bucket of each letter position of a word
+*
+* data: Struct containing all the data for the game.
+* word: given word to find the buckets of
+* bucketOf: set to the bucket of each position, -1 if it has none
+*
+* Returns: total number of words in the buckets
+*/
+int neighbour_buckets(Data* data, const char* word, int* bucketOf) {
+    int total = 0;
+    for (unsigned int pos = 0; pos < data->wordLen; pos++) {
+        unsigned int slot = find_bucket_slot(data, 
+                pattern_key(word, data->wordLen, pos));
+        bucketOf[pos] = data->bucketKeys[slot] == 0 ? -1 
+                : data->bucketOfSlot[slot];
+        if (bucketOf[pos] != -1) {
+            total += data->bucketStart[bucketOf[pos] + 1] 
+                    - data->bucketStart[bucketOf[pos]];
+        }
+    }
+    return total;
+}
+
+/* collect_neighbours()
+* −−−−−−−−−−−−−−−
+* Copies the words one letter different from a word out of its buckets
+*
+* data: Struct containing all the data for the game.
+* word: given word to find neighbours of
+* bucketOf: bucket of each position from neighbour_buckets()
+* neighbours: set to the dictionary indexes, must have room for them all
+*
+* Returns: number of neighbours found
+*/
+int collect_neighbours(Data* data, const char* word, const int* bucketOf,
+        int* neighbours) {
+    int count = 0;
+    for (unsigned int pos = 0; pos < data->wordLen; pos++) {
+        if (bucketOf[pos] == -1) {
+            continue;
         }
-        // Remove trailing newline character
-        if (input[strlen(input) - 1] == '\n') {
-            input[strlen(input) - 1] = '\0';
+        for (int j = data->bucketStart[bucketOf[pos]]; 
+                j < data->bucketStart[bucketOf[pos] + 1]; j++) {
+            int id = data->bucketWords[j];
+            //the word itself is in every one of its buckets
+            if (dict_word(data, id)[pos] 
+                    != toupper((unsigned char)word[pos])) {
+                neighbours[count++] = id;
+            }
         }
-        make_caps(input);
-        data = check_input(input, data);
     }
-    // Free dynamically allocated memory for input
-    free(input);
+    return count;
 }
 
-int main(int argc, char* argv[]) {
-    Data data;
-    data = set_false(data);
-    data = check_command_line(data, argc, argv);
-    data = length_check(data);
-    data = word_check(data);
-    data = step_check(data);
-    data = read_dictionary(data);
-    //Welcome message
-    fprintf(stdout, WELCOME, data.initWord, data.toWord, data.stepLim);
+/* copy_neighbours()
+* −−−−−−−−−−−−−−−
+* Finds all dictionary words exactly one letter different from the given
+* word into a buffer, in no particular order
+*
+* data: Struct containing all the data for the game.
+* word: given word to find neighbours of
+* neighbours: set to the dictionary indexes, must have room for
+* wordsInDict of them
+*
+* Returns: number of neighbours found
+*/
+int copy_neighbours(Data* data, const char* word, int* neighbours) {
+    int bucketOf[MAX_LENGTH];
+    neighbour_buckets(data, word, bucketOf);
+    return collect_neighbours(data, word, bucketOf, neighbours);
+}
+
+/* build_graph()
+* −−−−−−−−−−−−−−−
+* Builds the one letter difference graph as compressed sparse rows: the
+* neighbours of every word are found from its wildcard buckets once, and
+* stored one word after another in dictionary order. Each word's row keeps
+* the order of its buckets, which searches rely on for which ladder wins.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void build_graph(Data* data) {
+    //a word's neighbours are the rest of its buckets, so this is enough
+    long capacity = 1;
+    for (int b = 0; b < data->numBuckets; b++) {
+        long size = data->bucketStart[b + 1] - data->bucketStart[b];
+        capacity += size * (size - 1);
+    }
+    data->adjStart = (int* )arena_alloc(data->arena, 
+            sizeof(int) * (data->wordsInDict + 1));
+    data->adjIds = (int* )arena_alloc(data->arena, sizeof(int) * capacity);
+    int edges = 0;
+    for (int i = 0; i < data->wordsInDict; i++) {
+        data->adjStart[i] = edges;
+        edges += copy_neighbours(data, dict_word(data, i), 
+                data->adjIds + edges);
+    }
+    data->adjStart[data->wordsInDict] = edges;
+}
+
+/* use_graph()
+* −−−−−−−−−−−−−−−
+* Builds the word graph the first time something walks it, so games that
+* never search, rank or ask for help don't pay for it at start up. It
+* must be called before threads share the graph.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void use_graph(Data* data) {
+    if (data->adjStart == NULL) {
+        build_graph(data);
+    }
+}
+
+/* find_root()
+* −−−−−−−−−−−−−−−
+* Finds the root of a word's set in a union-find forest, halving the path
+* on the way
+*
+* parent: parent of each word, a root is its own parent
+* word: dictionary index of the word
+*
+* Returns: dictionary index of the root
+*/
+int find_root(int* parent, int word) {
+    while (parent[word] != word) {
+        parent[word] = parent[parent[word]];
+        word = parent[word];
+    }
+    return word;
+}
+
+/* label_components()
+* −−−−−−−−−−−−−−−
+* Finds the connected components of the one letter difference graph with
+* union-find. The words in a bucket are all one letter apart, bar repeats
+* of the same word, so each is joined to one word in the bucket that
+* differs from it. Components are numbered in order of their first word.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void label_components(Data* data) {
+    int* parent = (int* )malloc(sizeof(int) * (data->wordsInDict + 1));
+    for (int i = 0; i < data->wordsInDict; i++) {
+        parent[i] = i;
+    }
+    for (int b = 0; b < data->numBuckets; b++) {
+        int start = data->bucketStart[b];
+        int first = data->bucketWords[start];
+        int other = -1; //first word that differs from first, if any
+        for (int j = start + 1; j < data->bucketStart[b + 1]; j++) {
+            int word = data->bucketWords[j];
+            int partner = first;
+            if (strcmp(dict_word(data, word), dict_word(data, first)) == 0) {
+                //a repeat of first is joined through a different word
+                partner = other;
+            } else if (other == -1) {
+                other = word;
+            }
+            if (partner != -1) {
+                parent[find_root(parent, word)] = find_root(parent, partner);
+            }
+        }
+        //repeats of first seen before other still need joining to it
+        for (int j = start + 1; other != -1 && data->bucketWords[j] != other;
+                j++) {
+            parent[find_root(parent, data->bucketWords[j])] = 
+                    find_root(parent, other);
+        }
+    }
+    data->componentOf = (uint32_t* )arena_alloc(data->arena, 
+            sizeof(uint32_t) * (data->wordsInDict + 1));
+    data->numComponents = 0;
+    int* labelOf = (int* )malloc(sizeof(int) * (data->wordsInDict + 1));
+    for (int i = 0; i < data->wordsInDict; i++) {
+        labelOf[i] = -1;
+    }
+    for (int i = 0; i < data->wordsInDict; i++) {
+        int root = find_root(parent, i);
+        if (labelOf[root] == -1) {
+            labelOf[root] = data->numComponents++;
+        }
+        data->componentOf[i] = labelOf[root];
+    }
+    free(labelOf);
+    free(parent);
+}
+
+/* read_whole_file()
+* −−−−−−−−−−−−−−−
+* Reads everything from a file that can't be memory mapped (e.g. a pipe)
+* into an allocated buffer
+*
+* fd: file descriptor to read from
+* size: set to the number of bytes read
+*
+* Returns: allocated buffer holding the contents, must be freed
+*/
+char* read_whole_file(int fd, size_t* size) {
+    size_t capacity = READ_CHUNK;
+    char* contents = (char* )malloc(capacity);
+    ssize_t got;
+    *size = 0;
+    while ((got = read(fd, contents + *size, capacity - *size)) > 0) {
+        *size += got;
+        if (*size == capacity) {
+            capacity *= 2;
+            contents = (char* )realloc(contents, capacity);
+        }
+    }
+    return contents;
+}
+
+/* filter_words()
+* −−−−−−−−−−−−−−−
+* Scans the dictionary text in one pass and copies each line that is
+* wordLen letters long, in uppercase, into filteredDict
+*
+* data: Struct containing all the data for the game.
+* text: contents of the dictionary file
+* size: number of bytes in text
+*
+* Returns: Nothing
+*/
+void filter_words(Data* data, const char* text, size_t size) {
+    size_t stride = data->wordLen + 1;
+    //every kept word uses at least stride bytes of the file (its letters
+    //and a newline) bar the last, so this is enough for all of them
+    data->filteredDict = (char* )arena_alloc(data->arena, 
+            (size / stride + 1) * stride);
+    const char* end = text + size;
+    const char* line = text;
+    while (line < end) {
+        const char* newline = memchr(line, '\n', end - line);
+        const char* lineEnd = newline ? newline : end;
+        if (lineEnd - line == data->wordLen) {
+            char* word = data->filteredDict + data->wordsInDict * stride;
+            unsigned int i = 0;
+            while (i < data->wordLen && isalpha((unsigned char)line[i])) {
+                word[i] = toupper((unsigned char)line[i]);
+                i++;
+            }
+            if (i == data->wordLen) {
+                word[i] = '\0';
+                data->wordsInDict++;
+            }
+        }
+        line = lineEnd + 1;
+    }
+}
+
+/* cache_header()
+* −−−−−−−−−−−−−−−
+* Fills in the cache header describing the dictionary and word length, and
+* the counts of what has been built from it so far
+*
+* data: Struct containing all the data for the game.
+* info: stat of the dictionary file
+* path: full path of the dictionary file
+*
+* Returns: header for the cache file of this dictionary
+*/
+CacheHeader cache_header(Data* data, struct stat info, const char* path) {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.wordLen = data->wordLen;
+    header.dictMtimeSec = info.st_mtim.tv_sec;
+    header.dictMtimeNsec = info.st_mtim.tv_nsec;
+    header.dictSize = info.st_size;
+    header.pathLen = strlen(path);
+    header.wordsInDict = data->wordsInDict;
+    header.numComponents = data->numComponents;
+    header.numBuckets = data->numBuckets;
+    header.numEdges = data->adjStart ? data->adjStart[data->wordsInDict] : 0;
+    return header;
+}
+
+/* cache_layout()
+* −−−−−−−−−−−−−−−
+* Gets where each section of a cache file starts and how big it is. The
+* sections follow the header and the dictionary path in CacheSection
+* order, each padded to CACHE_ALIGN. The hash tables are sized from the
+* word count the same way they are built.
+*
+* header: header of the cache file
+* offsets: set to the offset of each section, and the size of the file
+* after the last (CACHE_SECTIONS + 1)
+* sizes: set to the number of bytes in each section (CACHE_SECTIONS)
+*
+* Returns: Nothing
+*/
+void cache_layout(CacheHeader header, size_t* offsets, size_t* sizes) {
+    size_t words = header.wordsInDict;
+    size_t dictHashSize = hash_table_size(words);
+    size_t bucketHashSize = hash_table_size(words * header.wordLen);
+    sizes[CACHE_WORDS] = words * (header.wordLen + 1);
+    sizes[CACHE_COMPONENTS] = sizeof(uint32_t) * words;
+    sizes[CACHE_DICT_HASH] = dictHashSize * header.wordLen;
+    sizes[CACHE_DICT_HASH_IDS] = sizeof(int) * dictHashSize;
+    sizes[CACHE_BUCKET_KEYS] = sizeof(uint64_t) * bucketHashSize;
+    sizes[CACHE_BUCKET_OF_SLOT] = sizeof(int) * bucketHashSize;
+    sizes[CACHE_BUCKET_START] = sizeof(int) * (header.numBuckets + 1);
+    sizes[CACHE_BUCKET_WORDS] = sizeof(int) * words * header.wordLen;
+    sizes[CACHE_PACKED] = sizeof(uint64_t) * words;
+    sizes[CACHE_ADJ_START] = sizeof(int) * (words + 1);
+    sizes[CACHE_ADJ_IDS] = sizeof(int) * (size_t)header.numEdges;
+    size_t offset = sizeof(CacheHeader) + header.pathLen;
+    for (int section = 0; section <= CACHE_SECTIONS; section++) {
+        offset = (offset + CACHE_ALIGN - 1) / CACHE_ALIGN * CACHE_ALIGN;
+        offsets[section] = offset;
+        if (section < CACHE_SECTIONS) {
+            offset += sizes[section];
+        }
+    }
+}
+
+/* hash_cache_body()
+* −−−−−−−−−−−−−−−
+* FNV-1a hash of every section of a cache file, taken eight bytes at a
+* time so checking a mapped cache stays cheap next to rebuilding it. The
+* last few bytes of a section are hashed as one zero filled chunk.
+*
+* sections: start of each section (CACHE_SECTIONS)
+* sizes: number of bytes in each section (CACHE_SECTIONS)
+*
+* Returns: hash of the sections
+*/
+uint64_t hash_cache_body(const void* const* sections, const size_t* sizes) {
+    uint64_t hash = FNV64_OFFSET;
+    for (int section = 0; section < CACHE_SECTIONS; section++) {
+        const char* bytes = sections[section];
+        for (size_t i = 0; i < sizes[section]; i += sizeof(uint64_t)) {
+            uint64_t chunk = 0;
+            size_t left = sizes[section] - i;
+            memcpy(&chunk, bytes + i, 
+                    left < sizeof(chunk) ? left : sizeof(chunk));
+            hash ^= chunk;
+            hash *= FNV64_PRIME;
+        }
+    }
+    return hash;
+}
+
+/* load_dict_cache()
+* −−−−−−−−−−−−−−−
+* Maps the cache file for the dictionary read-only, and uses its words,
+* their components, the lookup tables and the word graph in place if it
+* was built from the same dictionary path, mtime, size and word length
+* and its sections still hash to the bodyHash in its header
+*
+* data: Struct containing all the data for the game.
+* cacheName: path of the cache file
+* expected: header the cache file must match (apart from the counts and
+* bodyHash)
+* path: full path of the dictionary file
+*
+* Returns: Nothing, cacheMap is left NULL if the cache can't be used
+*/
+void load_dict_cache(Data* data, const char* cacheName, CacheHeader expected,
+        const char* path) {
+    int fd = open(cacheName, O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1 
+            || (size_t)info.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return;
+    }
+    char* map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    CacheHeader header;
+    memcpy(&header, map, sizeof(header));
+    size_t offsets[CACHE_SECTIONS + 1], sizes[CACHE_SECTIONS];
+    cache_layout(header, offsets, sizes);
+    expected.wordsInDict = header.wordsInDict;
+    expected.numComponents = header.numComponents;
+    expected.numBuckets = header.numBuckets;
+    expected.numEdges = header.numEdges;
+    expected.bodyHash = header.bodyHash;
+    //stale or foreign files are ignored, and rebuilt by the caller
+    if (memcmp(&header, &expected, sizeof(header)) != 0
+            || offsets[CACHE_SECTIONS] != (size_t)info.st_size
+            || memcmp(map + sizeof(header), path, header.pathLen) != 0) {
+        munmap(map, info.st_size);
+        return;
+    }
+    const void* sections[CACHE_SECTIONS];
+    for (int section = 0; section < CACHE_SECTIONS; section++) {
+        sections[section] = map + offsets[section];
+    }
+    //so are damaged ones, as their tables are trusted once mapped
+    if (hash_cache_body(sections, sizes) != header.bodyHash) {
+        munmap(map, info.st_size);
+        return;
+    }
+    data->cacheMap = map;
+    data->cacheMapSize = info.st_size;
+    data->wordsInDict = header.wordsInDict;
+    data->numComponents = header.numComponents;
+    data->numBuckets = header.numBuckets;
+    data->dictHashSize = hash_table_size(header.wordsInDict);
+    data->bucketHashSize = hash_table_size((long)header.wordsInDict 
+            * header.wordLen);
+    data->filteredDict = map + offsets[CACHE_WORDS];
+    data->componentOf = (uint32_t* )(map + offsets[CACHE_COMPONENTS]);
+    data->dictHash = map + offsets[CACHE_DICT_HASH];
+    data->dictHashIds = (int* )(map + offsets[CACHE_DICT_HASH_IDS]);
+    data->bucketKeys = (uint64_t* )(map + offsets[CACHE_BUCKET_KEYS]);
+    data->bucketOfSlot = (int* )(map + offsets[CACHE_BUCKET_OF_SLOT]);
+    data->bucketStart = (int* )(map + offsets[CACHE_BUCKET_START]);
+    data->bucketWords = (int* )(map + offsets[CACHE_BUCKET_WORDS]);
+    data->packedDict = (uint64_t* )(map + offsets[CACHE_PACKED]);
+    data->adjStart = (int* )(map + offsets[CACHE_ADJ_START]);
+    data->adjIds = (int* )(map + offsets[CACHE_ADJ_IDS]);
+}
+
+/* save_dict_cache()
+* −−−−−−−−−−−−−−−
+* Writes the filtered dictionary, everything built from it and the word
+* graph to a cache file. It is written to a temporary file first then
+* renamed, so other games never see part of it. Failures are ignored as
+* the cache is only an optimisation.
+*
+* data: Struct containing all the data for the game.
+* cacheName: path of the cache file
+* header: header describing the dictionary and what was built from it
+* path: full path of the dictionary file
+*
+* Returns: Nothing
+*/
+void save_dict_cache(Data* data, const char* cacheName, CacheHeader header,
+        const char* path) {
+    mkdir(data->dictCacheDir, S_IRWXU);
+    char tempName[strlen(cacheName) + 16];
+    sprintf(tempName, CACHE_TEMP_NAME, cacheName, (int)getpid());
+    FILE* file = fopen(tempName, "w");
+    if (file == NULL) {
+        return;
+    }
+    const void* sections[CACHE_SECTIONS] = {data->filteredDict, 
+            data->componentOf, data->dictHash, data->dictHashIds, 
+            data->bucketKeys, data->bucketOfSlot, data->bucketStart, 
+            data->bucketWords, data->packedDict, data->adjStart, 
+            data->adjIds};
+    size_t offsets[CACHE_SECTIONS + 1], sizes[CACHE_SECTIONS];
+    cache_layout(header, offsets, sizes);
+    header.bodyHash = hash_cache_body(sections, sizes);
+    char padding[CACHE_ALIGN] = {0};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(path, 1, header.pathLen, file);
+    fwrite(padding, 1, offsets[0] - sizeof(header) - header.pathLen, file);
+    for (int section = 0; section < CACHE_SECTIONS; section++) {
+        fwrite(sections[section], 1, sizes[section], file);
+        fwrite(padding, 1, offsets[section + 1] - offsets[section] 
+                - sizes[section], file);
+    }
+    if (fclose(file) != 0 || rename(tempName, cacheName) != 0) {
+        unlink(tempName);
+    }
+}
+
+/* read_dictionary()
+* −−−−−−−−−−−−−−−
+* Reads the dictionary file and stores all valid length words in an array.
+* The file is memory mapped and scanned once, with the kept words copied
+* into one buffer. If a cache directory is given and the cache file for
+* this dictionary and length is up to date, the words, lookup tables and
+* word graph are all used straight from the mapped file. Otherwise they
+* are built and the cache file is (re)written.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Error message prints and exits if unreadable or non-existent
+*/
+void read_dictionary(Data* data) {
+    if (data->dictSet == false) {
+        data->dict = DEF_DICT;
+    }
+    int fd = open(data->dict, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, FILE_NOT_OPENING, data->dict);
+        my_exit(FILE_ERROR_CODE, data);
+    }
+    struct stat info;
+    char* text = MAP_FAILED;
+    size_t size = 0;
+    bool regular = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    //cache files are keyed by the full path of the dictionary
+    char path[PATH_MAX];
+    char cacheName[data->dictCacheDir ? strlen(data->dictCacheDir) + 32 : 1];
+    if (data->dictCacheDir != NULL && regular 
+            && realpath(data->dict, path) != NULL) {
+        sprintf(cacheName, CACHE_NAME, data->dictCacheDir,
+                hash_word(path, strlen(path)), data->wordLen);
+        load_dict_cache(data, cacheName, cache_header(data, info, path), 
+                path);
+        if (data->cacheMap != NULL) {
+            close(fd);
+            return;
+        }
+    } else {
+        cacheName[0] = '\0';
+    }
+    if (regular && info.st_size > 0) {
+        size = info.st_size;
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (text != MAP_FAILED) {
+        madvise(text, size, MADV_SEQUENTIAL);
+        filter_words(data, text, size);
+        munmap(text, size);
+    } else {
+        //not a regular file, so it has to be read in
+        text = read_whole_file(fd, &size);
+        filter_words(data, text, size);
+        free(text);
+    }
+    close(fd);
+    build_dict_hash(data);
+    build_buckets(data);
+    pack_dictionary(data);
+    label_components(data);
+    if (cacheName[0] != '\0') {
+        //the graph is cached too, so cache hits never build it
+        use_graph(data);
+        save_dict_cache(data, cacheName, cache_header(data, info, path), 
+                path);
+    }
+}
+
+/* print_stdout()
+* −−−−−−−−−−−−−−−
+* Prints message to stdout
+*
+* message: Output message
+*
+* Returns: Nothing
+*/
+void print_stdout(char* message) {
+    fprintf(stdout, "%s\n", message);
+}
+
+/* dict_index()
+* −−−−−−−−−−−−−−−
+* Finds the given word in the dictionary, using the hash set built
+* when the dictionary was read
+*
+* word: given word to find
+* data: Struct containing all the data for the game.
+*
+* Returns: index of the word in the dictionary, -1 if not in it
+*/
+int dict_index(const char* word, Data* data) {
+    if (strlen(word) != data->wordLen) {
+        return -1;
+    }
+    unsigned int mask = data->dictHashSize - 1;
+    unsigned int slot = hash_word(word, data->wordLen) & mask;
+    char* entry = data->dictHash + (size_t)slot * data->wordLen;
+    while (entry[0] != '\0') {
+        if (memcmp(entry, word, data->wordLen) == 0) {
+            return data->dictHashIds[slot];
+        }
+        slot = (slot + 1) & mask;
+        entry = data->dictHash + (size_t)slot * data->wordLen;
+    }
+    return -1;
+}
+
+/* set_visited()
+* −−−−−−−−−−−−−−−
+* Marks or unmarks a word as on the ladder, in the visited bit of every
+* dictionary index it is at. Repeats of a word share all its buckets, so
+* they are all found in its first one.
+*
+* data: Struct containing all the data for the game.
+* id: dictionary index of the word, nothing is done if it is -1
+* onLadder: if the word is on the ladder
+*
+* Returns: Nothing
+*/
+void set_visited(Data* data, int id, bool onLadder) {
+    if (id == -1) {
+        return;
+    }
+    unsigned int slot = find_bucket_slot(data, 
+            pattern_key(dict_word(data, id), data->wordLen, 0));
+    int bucket = data->bucketOfSlot[slot];
+    for (int j = data->bucketStart[bucket]; 
+            j < data->bucketStart[bucket + 1]; j++) {
+        int repeat = data->bucketWords[j];
+        if (data->packedDict[repeat] != data->packedDict[id]) {
+            continue;
+        }
+        if (onLadder) {
+            data->visited[repeat / 8] |= 1 << (repeat % 8);
+        } else {
+            data->visited[repeat / 8] &= ~(1 << (repeat % 8));
+        }
+    }
+}
+
+/* start_ladder()
+* −−−−−−−−−−−−−−−
+* Sets up the visited bits for a game. The initial word is checked for by
+* name, as it may not be in the dictionary, so it is never marked.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void start_ladder(Data* data) {
+    if (data->visited == NULL) {
+        data->visited = (uint8_t* )arena_calloc(data->arena, 
+                data->wordsInDict / 8 + 1, 1);
+    }
+}
+
+/* forget_ladder()
+* −−−−−−−−−−−−−−−
+* Unmarks every word of a finished game's ladder, so the visited bits can
+* be used again without clearing all of them
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void forget_ladder(Data* data) {
+    for (int i = 0; i < data->attempt - 1; i++) {
+        set_visited(data, dict_index(data->givenWords[i], data), false);
+    }
+}
+
+/* word_visited()
+* −−−−−−−−−−−−−−−
+* Checks the visited bit of a dictionary word
+*
+* data: Struct containing all the data for the game.
+* id: dictionary index of the word
+*
+* Returns: boolean if the word is on the ladder
+*/
+bool word_visited(Data* data, int id) {
+    return (data->visited[id / 8] >> (id % 8)) & 1;
+}
+
+/* one_letter_diff()
+* −−−−−−−−−−−−−−−
+* Check if the given word was a previous word entered
+*
+* word1: given word to check
+* word2: given word to check against
+*
+* Returns: boolean the 2 words are only 1 letter different
+*/
+bool one_letter_diff(char* word1, char* word2) {
+    int diff = 0;
+    for (int i = 0; word1[i] != '\0' && diff < 2; i++) {
+        if (word1[i] != word2[i]) {
+            diff++;
+        }
+    }
+    if (diff == 1) {
+        return true;
+    }
+    return false;
+}
+
+/* find_neighbours()
+* −−−−−−−−−−−−−−−
+* Finds all dictionary words exactly one letter different from the given
+* word by looking up each of its wildcard buckets
+*
+* data: Struct containing all the data for the game.
+* word: given word to find neighbours of
+* neighbours: set to an allocated array of dictionary indexes. Must be
+* freed by the caller.
+* inOrder: if the neighbours need to be in dictionary order
+*
+* Returns: number of neighbours found
+*/
+int find_neighbours(Data* data, const char* word, int** neighbours,
+        bool inOrder) {
+    int bucketOf[MAX_LENGTH];
+    int total = neighbour_buckets(data, word, bucketOf);
+    *neighbours = (int* )malloc(sizeof(int) * (total + 1));
+    int count = collect_neighbours(data, word, bucketOf, *neighbours);
+    //each neighbour is only in one of the buckets, so just restore order
+    if (inOrder) {
+        qsort(*neighbours, count, sizeof(int), compare_ints);
+    }
+    return count;
+}
+
+/* expand_level()
+* −−−−−−−−−−−−−−−
+* Expands one level of a breadth first search. Every unseen neighbour of
+* the frontier gets its parent set and forms the next frontier. Neighbours
+* already seen by the other search are meeting points of the two.
+*
+* data: Struct containing all the data for the game.
+* frontier: dictionary indexes at the current level, replaced by the next
+* size: number of words in the frontier, updated to the next level
+* parent: parent of each word seen by this search, -2 if unseen
+* otherParent: parent of each word seen by the other search, -2 if unseen
+* otherDepth: depth of each word seen by the other search
+* depth: depth of each word seen by this search, set for the next level
+* meet: set to the best meeting word, if one is found at this level
+*
+* Returns: length of the ladder through meet, -1 if they didn't meet
+*/
+int expand_level(Data* data, int** frontier, int* size, int* parent,
+        const int* otherParent, const int* otherDepth, int* depth,
+        int* meet) {
+    int best = -1;
+    int capacity = *size * data->wordLen + 1;
+    int* next = (int* )malloc(sizeof(int) * capacity);
+    int nextSize = 0;
+    for (int f = 0; f < *size; f++) {
+        int from = (*frontier)[f];
+        for (int n = data->adjStart[from]; n < data->adjStart[from + 1]; 
+                n++) {
+            int to = data->adjIds[n];
+            if (parent[to] != -2) {
+                continue;
+            }
+            parent[to] = from;
+            depth[to] = depth[from] + 1;
+            if (otherParent[to] != -2) {
+                //finish the level as a later meeting could be shorter
+                int length = depth[to] + otherDepth[to];
+                if (best == -1 || length < best) {
+                    best = length;
+                    *meet = to;
+                }
+            }
+            if (nextSize == capacity) {
+                capacity *= 2;
+                next = (int* )realloc(next, sizeof(int) * capacity);
+            }
+            next[nextSize++] = to;
+        }
+    }
+    free(*frontier);
+    *frontier = next;
+    *size = nextSize;
+    return best;
+}
+
+/* solve_bfs()
+* −−−−−−−−−−−−−−−
+* Finds a shortest ladder with a breadth first search from each end. Each
+* round expands whichever search has the smaller frontier.
+*
+* data: Struct containing all the data for the game.
+* target: dictionary index of the target word
+* ladder: set as for solve_ladder()
+*
+* Returns: number of steps in the ladder, -1 if there is no ladder
+*/
+int solve_bfs(Data* data, int target, int** ladder) {
+    int* parentF = (int* )malloc(sizeof(int) * data->wordsInDict);
+    int* parentB = (int* )malloc(sizeof(int) * data->wordsInDict);
+    int* depthF = (int* )malloc(sizeof(int) * data->wordsInDict);
+    int* depthB = (int* )malloc(sizeof(int) * data->wordsInDict);
+    for (int i = 0; i < data->wordsInDict; i++) {
+        parentF[i] = -2;
+        parentB[i] = -2;
+    }
+    int sizeF, sizeB = 1;
+    int* frontierF;
+    int* frontierB = (int* )malloc(sizeof(int));
+    frontierB[0] = target;
+    parentB[target] = -1;
+    depthB[target] = 0;
+    //first level comes from the initial word, which may not be in the
+    //dictionary, so every later level only needs dictionary words
+    sizeF = find_neighbours(data, data->initWord, &frontierF, false);
+    int levelF = 1, levelB = 0, meet = -1, length = -1;
+    for (int f = 0; f < sizeF; f++) {
+        parentF[frontierF[f]] = -1;
+        depthF[frontierF[f]] = 1;
+        if (frontierF[f] == target) {
+            meet = target;
+            length = 1;
+        }
+    }
+    while (length == -1 && sizeF > 0 && sizeB > 0 
+            && levelF + levelB < data->stepLim) {
+        if (sizeF <= sizeB) {
+            length = expand_level(data, &frontierF, &sizeF, parentF, parentB,
+                    depthB, depthF, &meet);
+            levelF++;
+        } else {
+            length = expand_level(data, &frontierB, &sizeB, parentB, parentF,
+                    depthF, depthB, &meet);
+            levelB++;
+        }
+    }
+    if (length != -1 && length <= data->stepLim) {
+        //walk back to the initial word, then forward to the target
+        *ladder = (int* )malloc(sizeof(int) * length);
+        int step = depthF[meet] - 1;
+        for (int i = meet; i != -1; i = parentF[i]) {
+            (*ladder)[step--] = i;
+        }
+        step = depthF[meet];
+        for (int i = parentB[meet]; i != -1; i = parentB[i]) {
+            (*ladder)[step++] = i;
+        }
+    } else {
+        length = -1;
+    }
+    free(frontierF);
+    free(frontierB);
+    free(parentF);
+    free(parentB);
+    free(depthF);
+    free(depthB);
+    return length;
+}
+
+/* open_before()
+* −−−−−−−−−−−−−−−
+* Orders entries of the A* open set: lowest estimate first, then the most
+* steps taken, as that word is closer to the target, then dictionary order
+*
+* a: entry to check
+* b: entry to check against
+*
+* Returns: boolean a comes before b
+*/
+bool open_before(OpenEntry a, OpenEntry b) {
+    if (a.estimate != b.estimate) {
+        return a.estimate < b.estimate;
+    }
+    if (a.steps != b.steps) {
+        return a.steps > b.steps;
+    }
+    return a.word < b.word;
+}
+
+/* open_push()
+* −−−−−−−−−−−−−−−
+* Adds an entry to the A* open set, a binary min-heap. The open set grows
+* as needed.
+*
+* open: the open set, may be moved when it grows
+* size: number of entries in the open set, updated
+* capacity: room in the open set, updated when it grows
+* entry: entry to add
+*
+* Returns: Nothing
+*/
+void open_push(OpenEntry** open, int* size, int* capacity, OpenEntry entry) {
+    if (*size == *capacity) {
+        *capacity *= 2;
+        *open = (OpenEntry* )realloc(*open, sizeof(OpenEntry) * *capacity);
+    }
+    OpenEntry* heap = *open;
+    int child = (*size)++;
+    while (child > 0 && open_before(entry, heap[(child - 1) / 2])) {
+        heap[child] = heap[(child - 1) / 2];
+        child = (child - 1) / 2;
+    }
+    heap[child] = entry;
+}
+
+/* open_pop()
+* −−−−−−−−−−−−−−−
+* Removes the first entry of the A* open set
+*
+* open: the open set
+* size: number of entries in the open set, must be at least one, updated
+*
+* Returns: the entry with the lowest estimate
+*/
+OpenEntry open_pop(OpenEntry* open, int* size) {
+    OpenEntry first = open[0];
+    OpenEntry last = open[--(*size)];
+    int parent = 0;
+    while (2 * parent + 1 < *size) {
+        int child = 2 * parent + 1;
+        if (child + 1 < *size && open_before(open[child + 1], open[child])) {
+            child++;
+        }
+        if (!open_before(open[child], last)) {
+            break;
+        }
+        open[parent] = open[child];
+        parent = child;
+    }
+    open[parent] = last;
+    return first;
+}
+
+/* solve_astar()
+* −−−−−−−−−−−−−−−
+* Finds a shortest ladder with an A* search from the initial word. A word's
+* estimate is the steps taken to it plus the letters it still differs from
+* the target in. A step changes one letter, so the estimate never exceeds
+* the true length, and the first time the target leaves the open set its
+* ladder is a shortest one. Words whose estimate is past stepLim are never
+* added.
+*
+* data: Struct containing all the data for the game.
+* target: dictionary index of the target word
+* ladder: set as for solve_ladder()
+*
+* Returns: number of steps in the ladder, -1 if there is no ladder
+*/
+int solve_astar(Data* data, int target, int** ladder) {
+    uint64_t goal = data->packedDict[target];
+    uint8_t* steps = (uint8_t* )malloc(data->wordsInDict);
+    int* parent = (int* )malloc(sizeof(int) * data->wordsInDict);
+    //closed words are kept one bit each
+    uint8_t* closed = (uint8_t* )calloc(data->wordsInDict / 8 + 1, 1);
+    memset(steps, UINT8_MAX, data->wordsInDict);
+    int size = 0, capacity = 64;
+    OpenEntry* open = (OpenEntry* )malloc(sizeof(OpenEntry) * capacity);
+    //first step comes from the initial word, which may not be in the
+    //dictionary, so every later step only needs dictionary words
+    int* first;
+    int count = find_neighbours(data, data->initWord, &first, false);
+    for (int f = 0; f < count; f++) {
+        OpenEntry entry = {1 + packed_distance(data->packedDict[first[f]], 
+                goal), 1, first[f]};
+        if (entry.estimate <= data->stepLim && steps[first[f]] > 1) {
+            steps[first[f]] = 1;
+            parent[first[f]] = -1;
+            open_push(&open, &size, &capacity, entry);
+        }
+    }
+    free(first);
+    int length = -1;
+    while (size > 0) {
+        OpenEntry entry = open_pop(open, &size);
+        int from = entry.word;
+        if (closed[from / 8] & (1 << (from % 8))) {
+            continue;
+        }
+        closed[from / 8] |= 1 << (from % 8);
+        if (from == target) {
+            length = entry.steps;
+            break;
+        }
+        for (int n = data->adjStart[from]; n < data->adjStart[from + 1]; 
+                n++) {
+            int to = data->adjIds[n];
+            OpenEntry next = {entry.steps + 1 + packed_distance(
+                    data->packedDict[to], goal), entry.steps + 1, to};
+            if (next.steps < steps[to] && next.estimate <= data->stepLim) {
+                steps[to] = next.steps;
+                parent[to] = from;
+                open_push(&open, &size, &capacity, next);
+            }
+        }
+    }
+    if (length != -1) {
+        *ladder = (int* )malloc(sizeof(int) * length);
+        int step = length - 1;
+        for (int i = target; i != -1; i = parent[i]) {
+            (*ladder)[step--] = i;
+        }
+    }
+    free(open);
+    free(closed);
+    free(parent);
+    free(steps);
+    return length;
+}
+
+/* deepen()
+* −−−−−−−−−−−−−−−
+* Depth first search of one IDA* iteration, from the last word of the
+* ladder so far. Words whose estimate is past the bound aren't expanded,
+* and neither are words already on the ladder. A word already expanded in
+* this iteration in as few steps isn't expanded again: everything within
+* the bound from it has been searched, so transpositions are only
+* searched once.
+*
+* data: Struct containing all the data for the game.
+* search: the search, its path holds the ladder so far
+* steps: number of steps in the ladder so far, at least one
+*
+* Returns: -1 if the ladder reached the target, otherwise the lowest
+* estimate past the bound that was seen, INT_MAX if there was none
+*/
+int deepen(Data* data, DeepeningSearch* search, int steps) {
+    int word = search->path[steps - 1];
+    int estimate = steps + packed_distance(data->packedDict[word], 
+            search->goal);
+    if (estimate > search->bound) {
+        return estimate;
+    }
+    if (word == search->target) {
+        return -1;
+    }
+    //the first visit saw every estimate past the bound this one would
+    if (search->bestSteps[word] <= steps) {
+        return INT_MAX;
+    }
+    search->bestSteps[word] = steps;
+    int lowest = INT_MAX;
+    for (int n = data->adjStart[word]; n < data->adjStart[word + 1]; n++) {
+        int to = data->adjIds[n];
+        bool onPath = to == search->start;
+        for (int s = 0; s < steps && !onPath; s++) {
+            onPath = search->path[s] == to;
+        }
+        if (onPath) {
+            continue;
+        }
+        search->path[steps] = to;
+        int result = deepen(data, search, steps + 1);
+        if (result == -1) {
+            return -1;
+        }
+        if (result < lowest) {
+            lowest = result;
+        }
+    }
+    return lowest;
+}
+
+/* solve_idastar()
+* −−−−−−−−−−−−−−−
+* Finds a shortest ladder with an IDA* search: depth first searches from
+* the initial word, each allowing estimates up to the lowest one the last
+* search went past. It uses the same estimate as solve_astar() but only
+* remembers the ladder it is on and a byte per word of the fewest steps
+* it was expanded at, so it needs far less memory at the cost of
+* revisiting words between iterations.
+*
+* data: Struct containing all the data for the game.
+* target: dictionary index of the target word
+* ladder: set as for solve_ladder()
+*
+* Returns: number of steps in the ladder, -1 if there is no ladder
+*/
+int solve_idastar(Data* data, int target, int** ladder) {
+    DeepeningSearch search;
+    search.goal = data->packedDict[target];
+    search.target = target;
+    search.start = dict_index(data->initWord, data);
+    search.path = (int* )malloc(sizeof(int) * (data->stepLim + 1));
+    search.bestSteps = (uint8_t* )malloc(data->wordsInDict + 1);
+    search.bound = packed_distance(pack_word(data->initWord, data->wordLen),
+            search.goal);
+    int* first;
+    int count = find_neighbours(data, data->initWord, &first, false);
+    int length = -1;
+    while (length == -1 && search.bound <= (int)data->stepLim) {
+        int lowest = INT_MAX;
+        memset(search.bestSteps, UINT8_MAX, data->wordsInDict);
+        for (int f = 0; f < count && length == -1; f++) {
+            search.path[0] = first[f];
+            int result = deepen(data, &search, 1);
+            if (result == -1) {
+                //the ladder is the path up to the target
+                length = 0;
+                while (search.path[length] != target) {
+                    length++;
+                }
+                length++;
+            } else if (result < lowest) {
+                lowest = result;
+            }
+        }
+        if (lowest == INT_MAX) {
+            break;
+        }
+        search.bound = lowest;
+    }
+    if (length != -1) {
+        *ladder = (int* )malloc(sizeof(int) * length);
+        memcpy(*ladder, search.path, sizeof(int) * length);
+    }
+    free(first);
+    free(search.bestSteps);
+    free(search.path);
+    return length;
+}
+
+/* solve_ladder()
+* −−−−−−−−−−−−−−−
+* Finds a shortest ladder from the initial word to the target word, of at
+* most stepLim steps, with the search chosen by --solve-algo. The initial
+* word doesn't have to be in the dictionary but every other word does.
+*
+* data: Struct containing all the data for the game.
+* ladder: set to an allocated array of the dictionary indexes of each word
+* after the initial word, ending with the target. Must be freed by the
+* caller. Set to NULL if there is no ladder.
+*
+* Returns: number of steps in the ladder, -1 if there is no ladder
+*/
+int solve_ladder(Data* data, int** ladder) {
+    *ladder = NULL;
+    int target = dict_index(data->toWord, data);
+    if (target == -1 || data->wordsInDict == 0) {
+        return -1;
+    }
+    //words in different components can never be joined
+    int start = dict_index(data->initWord, data);
+    if (start != -1 
+            && data->componentOf[start] != data->componentOf[target]) {
+        return -1;
+    }
+    use_graph(data);
+    if (data->solveAlgo == SOLVE_ASTAR) {
+        return solve_astar(data, target, ladder);
+    } else if (data->solveAlgo == SOLVE_IDASTAR) {
+        return solve_idastar(data, target, ladder);
+    }
+    return solve_bfs(data, target, ladder);
+}
+
+/* start_ladders()
+* −−−−−−−−−−−−−−−
+* Lays out the shortest ladders from the initial word to the target word
+* with a breadth first search from the target. It stops at the first
+* level that holds a neighbour of the initial word, or past stepLim, so
+* every word with a distance set is on a shortest ladder or as close to
+* the target as one. Ladders through each word are counted level by level
+* rather than walked, so the count is cheap however many there are.
+*
+* data: Struct containing all the data for the game.
+* walk: set up to walk the ladders with next_ladder(), freed with
+* end_ladders() whatever is returned
+* count: set to the number of shortest ladders, UINT64_MAX if more
+*
+* Returns: number of steps in the shortest ladders, -1 if there are none
+*/
+int start_ladders(Data* data, LadderWalk* walk, uint64_t* count) {
+    use_graph(data);
+    walk->toTarget = NULL;
+    walk->path = (int* )malloc(sizeof(int) * (data->stepLim + 1));
+    walk->numFirst = find_neighbours(data, data->initWord, &walk->first, 
+            true);
+    walk->steps = -1;
+    walk->depth = -1;
+    *count = 0;
+    int target = dict_index(data->toWord, data);
+    int start = dict_index(data->initWord, data);
+    if (target == -1 || (start != -1 
+            && data->componentOf[start] != data->componentOf[target])) {
+        return -1;
+    }
+    walk->toTarget = (uint8_t* )malloc(data->wordsInDict);
+    memset(walk->toTarget, UINT8_MAX, data->wordsInDict);
+    uint64_t* paths = (uint64_t* )calloc(data->wordsInDict, 
+            sizeof(uint64_t));
+    int* queue = (int* )malloc(sizeof(int) * data->wordsInDict);
+    int head = 0, tail = 0;
+    queue[tail++] = target;
+    walk->toTarget[target] = 0;
+    paths[target] = 1;
+    for (int level = 0; head < tail && level < (int)data->stepLim; 
+            level++) {
+        for (int f = 0; f < walk->numFirst; f++) {
+            if (walk->toTarget[walk->first[f]] == level) {
+                walk->steps = level + 1;
+                *count = *count + paths[walk->first[f]] < *count 
+                        ? UINT64_MAX : *count + paths[walk->first[f]];
+            }
+        }
+        if (walk->steps != -1) {
+            break;
+        }
+        for (int end = tail; head < end; head++) {
+            int from = queue[head];
+            for (int n = data->adjStart[from]; n < data->adjStart[from + 1];
+                    n++) {
+                int to = data->adjIds[n];
+                if (walk->toTarget[to] == UINT8_MAX 
+                        && dict_index(dict_word(data, to), data) != to) {
+                    //repeats of a word would list its ladders again, so
+                    //they get a distance no ladder uses
+                    walk->toTarget[to] = UINT8_MAX - 1;
+                } else if (walk->toTarget[to] == UINT8_MAX) {
+                    walk->toTarget[to] = level + 1;
+                    queue[tail++] = to;
+                }
+                if (walk->toTarget[to] == level + 1) {
+                    //ladders to the target add up, up to what fits
+                    paths[to] = paths[to] + paths[from] < paths[to] 
+                            ? UINT64_MAX : paths[to] + paths[from];
+                }
+            }
+        }
+    }
+    free(queue);
+    free(paths);
+    return walk->steps;
+}
+
+/* next_step()
+* −−−−−−−−−−−−−−−
+* Finds the next word a shortest ladder can take at one step, after the
+* one it took last
+*
+* data: Struct containing all the data for the game.
+* walk: the walk, its path holds the ladder up to the step
+* depth: index of the step in the path
+*
+* Returns: lowest dictionary index after path[depth] that is one step
+* closer to the target than the word before, -1 if there is none
+*/
+int next_step(Data* data, LadderWalk* walk, int depth) {
+    int* options = walk->first;
+    int numOptions = walk->numFirst;
+    if (depth > 0) {
+        options = data->adjIds + data->adjStart[walk->path[depth - 1]];
+        numOptions = data->adjStart[walk->path[depth - 1] + 1]
+                - data->adjStart[walk->path[depth - 1]];
+    }
+    int next = -1;
+    for (int i = 0; i < numOptions; i++) {
+        int word = options[i];
+        if (walk->toTarget[word] == walk->steps - 1 - depth 
+                && word > walk->path[depth] && (next == -1 || word < next)) {
+            next = word;
+        }
+    }
+    return next;
+}
+
+/* next_ladder()
+* −−−−−−−−−−−−−−−
+* Moves the walk on to its next shortest ladder, in order of the
+* dictionary indexes of its words. Only one ladder is held at a time.
+*
+* data: Struct containing all the data for the game.
+* walk: the walk, its path is set to the words of the next ladder after
+* the initial word
+*
+* Returns: boolean there was another ladder
+*/
+bool next_ladder(Data* data, LadderWalk* walk) {
+    if (walk->steps == -1) {
+        return false;
+    }
+    if (walk->depth == -1) {
+        walk->depth = 0;
+        walk->path[0] = -1;
+    }
+    //every word with a step left has a next step, so this never dead ends
+    while (walk->depth >= 0) {
+        int next = next_step(data, walk, walk->depth);
+        if (next == -1) {
+            walk->depth--;
+            continue;
+        }
+        walk->path[walk->depth] = next;
+        if (walk->depth == walk->steps - 1) {
+            return true;
+        }
+        walk->path[++walk->depth] = -1;
+    }
+    walk->steps = -1;
+    return false;
+}
+
+/* end_ladders()
+* −−−−−−−−−−−−−−−
+* Frees a walk of the shortest ladders
+*
+* walk: the walk
+*
+* Returns: Nothing
+*/
+void end_ladders(LadderWalk* walk) {
+    free(walk->toTarget);
+    free(walk->first);
+    free(walk->path);
+}
+
+/* print_ladders()
+* −−−−−−−−−−−−−−−
+* Prints how many shortest ladders there are between the words, then
+* each of them on a line, up to ladderLimit of them
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: number of steps in the shortest ladders, -1 if there are none
+*/
+int print_ladders(Data* data) {
+    LadderWalk walk;
+    uint64_t count;
+    int steps = start_ladders(data, &walk, &count);
+    if (steps == -1) {
+        fprintf(stdout, NO_LADDER, data->initWord, data->toWord, data->stepLim);
+        end_ladders(&walk);
+        return -1;
+    }
+    fprintf(stdout, LADDERS_FOUND, count, data->initWord, data->toWord, 
+            steps);
+    uint64_t listed = 0;
+    while ((data->ladderLimit == -1 || listed < (uint64_t)data->ladderLimit)
+            && next_ladder(data, &walk)) {
+        fprintf(stdout, " %s", data->initWord);
+        for (int i = 0; i < steps; i++) {
+            fprintf(stdout, " %s", dict_word(data, walk.path[i]));
+        }
+        fprintf(stdout, "\n");
+        listed++;
+    }
+    if (listed < count) {
+        fprintf(stdout, LADDERS_MORE, count - listed);
+    }
+    end_ladders(&walk);
+    return steps;
+}
+
+/* print_ladder()
+* −−−−−−−−−−−−−−−
+* Prints a shortest ladder between the words and exits, or every one of
+* them if --ladders was given
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Message prints and exits if there is no ladder within stepLim
+*/
+void print_ladder(Data* data) {
+    if (data->listLadders == true) {
+        my_exit(print_ladders(data) == -1 ? NO_LADDER_CODE : 0, data);
+    }
+    int* ladder;
+    int steps = solve_ladder(data, &ladder);
+    if (steps == -1) {
+        fprintf(stdout, NO_LADDER, data->initWord, data->toWord, data->stepLim);
+        my_exit(NO_LADDER_CODE, data);
+    }
+    fprintf(stdout, LADDER_FOUND, data->initWord, data->toWord, steps);
+    fprintf(stdout, " %s\n", data->initWord);
+    for (int i = 0; i < steps; i++) {
+        fprintf(stdout, " %s\n", dict_word(data, ladder[i]));
+    }
+    free(ladder);
+    my_exit(0, data);
+}
+
+/* reject_unsolvable()
+* −−−−−−−−−−−−−−−
+* Draws new random words while the random word pair has no ladder within
+* stepLim. Words given on the command line are never changed. Every pair
+* drawn is checked, and if none of MAX_REDRAWS redraws has a ladder the
+* pair word_check() accepted is put back. The check always uses the
+* breadth first search, as --solve-algo idastar can be slow on some pairs.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void reject_unsolvable(Data* data) {
+    if (data->initWordSet == true && data->toWordSet == true) {
+        return;
+    }
+    char firstInit[data->wordLen + 1], firstTo[data->wordLen + 1];
+    strcpy(firstInit, data->initWord);
+    strcpy(firstTo, data->toWord);
+    SolveAlgo chosen = data->solveAlgo;
+    data->solveAlgo = SOLVE_BFS;
+    for (int draw = 0; draw <= MAX_REDRAWS; draw++) {
+        int* ladder;
+        if (strcasecmp(data->initWord, data->toWord) != 0 
+                && solve_ladder(data, &ladder) != -1) {
+            free(ladder);
+            data->solveAlgo = chosen;
+            return;
+        }
+        if (draw == MAX_REDRAWS) {
+            break;
+        }
+        if (data->initWordSet == false) {
+            strcpy(data->initWord, get_uqwordladder_word(data->wordLen));
+        }
+        if (data->toWordSet == false) {
+            strcpy(data->toWord, get_uqwordladder_word(data->wordLen));
+        }
+    }
+    data->solveAlgo = chosen;
+    strcpy(data->initWord, firstInit);
+    strcpy(data->toWord, firstTo);
+}
+
+/* build_target_map()
+* −−−−−−−−−−−−−−−
+* Finds how many steps every dictionary word is from the target word, with
+* one breadth first search from the target. The search stops at stepLim,
+* as no word further than that can ever finish a ladder, and those words
+* are left as UINT8_MAX.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void build_target_map(Data* data) {
+    use_graph(data);
+    data->toTarget = (uint8_t* )arena_alloc(data->arena, 
+            data->wordsInDict + 1);
+    memset(data->toTarget, UINT8_MAX, data->wordsInDict);
+    int target = dict_index(data->toWord, data);
+    if (target == -1) {
+        //the target can never be entered, so no ladder can finish
+        return;
+    }
+    int* queue = (int* )malloc(sizeof(int) * data->wordsInDict);
+    int head = 0, tail = 0;
+    queue[tail++] = target;
+    data->toTarget[target] = 0;
+    while (head < tail) {
+        int from = queue[head++];
+        if (data->toTarget[from] == data->stepLim) {
+            break;
+        }
+        for (int n = data->adjStart[from]; n < data->adjStart[from + 1]; 
+                n++) {
+            int to = data->adjIds[n];
+            if (data->toTarget[to] == UINT8_MAX) {
+                data->toTarget[to] = data->toTarget[from] + 1;
+                queue[tail++] = to;
+            }
+        }
+    }
+    free(queue);
+}
+
+/* check_hopeless()
+* −−−−−−−−−−−−−−−
+* Checks if the word just entered can still reach the target in the steps
+* left. Words already on the ladder aren't ruled out of the rest of it, so
+* a game is only called hopeless when it certainly is.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Message prints and the game ends if it is hopeless and --hopeless
+* end was given
+*/
+void check_hopeless(Data* data) {
+    char* word = data->givenWords[data->attempt - 2];
+    int stepsLeft = data->stepLim - (data->attempt - 1);
+    if (data->toTarget[dict_index(word, data)] <= stepsLeft) {
+        return;
+    }
+    if (data->hopeless == HOPELESS_WARN) {
+        fprintf(stdout, HOPELESS_WARNING, word, stepsLeft, data->toWord);
+    } else {
+        fprintf(stdout, HOPELESS_OVER, word, stepsLeft, data->toWord);
+        if (data->listLadders == true) {
+            print_ladders(data);
+        }
+        my_exit(GAME_OVER_CODE, data);
+    }
+}
+
+/* compare_uint64s()
+* −−−−−−−−−−−−−−−
+* qsort() comparison function for uint64_ts in ascending order
+*
+* a: pointer to first uint64_t
+* b: pointer to second uint64_t
+*
+* Returns: negative, zero or positive as a is less, equal or greater than b
+*/
+int compare_uint64s(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* rank_by_distance()
+* −−−−−−−−−−−−−−−
+* Sorts dictionary indexes by how many steps their words are from the
+* target, keeping dictionary order between words as far away. Each index
+* is sorted with its distance above it in one key.
+*
+* data: Struct containing all the data for the game.
+* words: dictionary indexes to sort, in dictionary order
+* numWords: number of indexes
+*
+* Returns: Nothing
+*/
+void rank_by_distance(Data* data, int* words, int numWords) {
+    uint64_t* keys = (uint64_t* )arena_alloc(data->arena, 
+            sizeof(uint64_t) * (numWords + 1));
+    for (int i = 0; i < numWords; i++) {
+        keys[i] = (uint64_t)data->toTarget[words[i]] << 32 
+                | (uint32_t)words[i];
+    }
+    qsort(keys, numWords, sizeof(uint64_t), compare_uint64s);
+    for (int i = 0; i < numWords; i++) {
+        words[i] = (int)(uint32_t)keys[i];
+    }
+}
+
+/* print_suggestions()
+* −−−−−−−−−−−−−−−
+* Prints all vaild attempts user can make or no suggestions available.
+* The suggestions point at the dictionary's own words rather than copies.
+* With --rank-hints the words closest to the target come first, and with
+* --hint-limit only that many are printed.
+*
+* data: Struct containing all the data for the game.
+* previous: given word to check against
+*
+* Returns: Nothing
+*/
+void print_suggestions(Data* data, char* previous) {    
+    use_graph(data);
+    //the suggestion list only lives until it is printed
+    ArenaMark mark = arena_mark(data->arena);
+    //dictionary words have their neighbours ready, others need a scan
+    int from = dict_index(previous, data);
+    int* neighbours = (int* )arena_alloc(data->arena, 
+            sizeof(int) * (data->wordsInDict + 1));
+    int numNeighbours;
+    if (from != -1) {
+        numNeighbours = data->adjStart[from + 1] - data->adjStart[from];
+        memcpy(neighbours, data->adjIds + data->adjStart[from], 
+                sizeof(int) * numNeighbours);
+        qsort(neighbours, numNeighbours, sizeof(int), compare_ints);
+    } else {
+        numNeighbours = scan_one_diff(pack_word(previous, data->wordLen),
+                data->packedDict, data->wordsInDict, neighbours);
+    }
+    if (data->rankHints == true) {
+        rank_by_distance(data, neighbours, numNeighbours);
+    }
+    data->sugWords = (char** )arena_alloc(data->arena, 
+            sizeof(char*) * (numNeighbours + 1));
+    data->sugWordsLen = 0;
+    //Check if given word is final word
+    if (one_letter_diff(previous, data->toWord) == true) {
+        data->sugWords[data->sugWordsLen] = data->toWord;
+        data->sugWordsLen++;
+    } 
+    //adds all valid words to array, candidates come from the scan kernel
+    for (int n = 0; n < numNeighbours; n++) {
+        char* word = dict_word(data, neighbours[n]);
+        if (word_visited(data, neighbours[n]) == false
+                && strcmp(word, data->toWord) != 0
+                && strcmp(word, data->initWord) != 0) {
+            data->sugWords[data->sugWordsLen] = word;
+            data->sugWordsLen++;
+        }
+    }
+    int shown = data->sugWordsLen;
+    if (data->hintLimit != 0 && shown > data->hintLimit) {
+        shown = data->hintLimit;
+    }
+    if (data->sugWordsLen == 0) {
+        print_stdout("No suggestions available.");
+    } else {
+        print_stdout("Suggestions:-----------");
+        for (int i = 0; i < shown; i++) {
+            fprintf(stdout, " %s\n", data->sugWords[i]);
+        }
+        if (shown < data->sugWordsLen) {
+            fprintf(stdout, HINTS_MORE, data->sugWordsLen - shown);
+        }
+        print_stdout("-----End of Suggestions");
+    }
+    //the list is released, so nothing is left pointing into it
+    arena_reset(data->arena, mark);
+    data->sugWords = NULL;
+    data->sugWordsLen = 0;
+}
+
+/* apply_move()
+* −−−−−−−−−−−−−−−
+* Checks a word against the rules and adds it to the ladder if it is
+* valid. Nothing is printed, so games can be played without a terminal.
+*
+* data: Struct containing all the data for the game.
+* input: given word, in uppercase
+*
+* Returns: outcome of the move
+*/
+MoveResult apply_move(Data* data, char* input) {
+    //-2 cause attempt starts at 1
+    char* previous = data->attempt == 1 ? data->initWord 
+            : data->givenWords[data->attempt - 2];
+    if (strlen(input) != data->wordLen) {
+        return MOVE_BAD_LENGTH;
+    } else if (check_chars(input) == false) {
+        return MOVE_NOT_LETTERS;
+    } else if (one_letter_diff(input, previous) == false) {
+        return MOVE_NOT_ONE_DIFF;
+    }
+    //one lookup serves both the repeat and the dictionary checks
+    int id = dict_index(input, data);
+    if (strcmp(input, data->initWord) == 0 
+            || (id != -1 && word_visited(data, id))) {
+        return MOVE_PREVIOUS;
+    } else if (id == -1) {
+        return MOVE_NOT_IN_DICT;
+    } else if (strcmp(input, data->toWord) == 0) {
+        return MOVE_SOLVED;
+    } else if (data->attempt == data->stepLim) {
+        return MOVE_OUT_OF_STEPS;
+    }
+    //adds given valid word to the array
+    data->givenWords[data->attempt - 1] = arena_strdup(data->arena, input);
+    set_visited(data, id, true);
+    data->attempt++;
+    return MOVE_ACCEPTED;
+}
+
+/* check_input()
+* −−−−−−−−−−−−−−−
+* Gets user input and checks if it is valid
+*
+* data: Struct containing all the data for the game.
+* input: users input
+*
+* Returns: Nothing
+* Errors: Message prints and exits if game won or step limit reached 
+*/
+void check_input(char input[MAX_LENGTH + 2], Data* data){
+    if (strcmp(input, "?") == 0) {
+        if (data->attempt == 1) {
+            print_suggestions(data, data->initWord);
+        } else {
+            print_suggestions(data, data->givenWords[data->attempt - 2]);
+        }
+        return;
+    }
+    switch (apply_move(data, input)) {
+        case MOVE_BAD_LENGTH:
+            fprintf(stdout, "Word should have %d characters - try again.\n",
+                    data->wordLen);
+            break;
+        case MOVE_NOT_LETTERS:
+            print_stdout(ONLY_LETTERS);
+            break;
+        case MOVE_NOT_ONE_DIFF:
+            print_stdout(DIFFER_ONE);
+            break;
+        case MOVE_PREVIOUS:
+            print_stdout(NO_PREVIOUS);
+            break;
+        case MOVE_NOT_IN_DICT:
+            print_stdout(NOT_IN_DICT);
+            break;
+        case MOVE_SOLVED:
+            fprintf(stdout, "Well done - you solved the ladder in %d steps.\n",
+                    data->attempt);
+            if (data->listLadders == true) {
+                print_ladders(data);
+            }
+            my_exit(0, data);
+            break;
+        case MOVE_OUT_OF_STEPS:
+            print_stdout(GAME_OVER);
+            if (data->listLadders == true) {
+                print_ladders(data);
+            }
+            my_exit(GAME_OVER_CODE, data);
+            break;
+        case MOVE_ACCEPTED:
+            if (data->hopeless != HOPELESS_IGNORE) {
+                check_hopeless(data);
+            }
+            break;
+    }
+}
+
+/* game_loop()
+* −−−−−−−−−−−−−−−
+* Gets user input and checks if it is valid. Input is read in blocks by a
+* LineReader, so long scripted games aren't read a line at a time.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Message prints and exits if exited 
+*/
+void game_loop(Data* data) {
+    LineReader reader;
+    open_reader(&reader, STDIN_FILENO);
+    while (1) {
+        fprintf(stdout, ENTER_WORD, data->attempt);
+        // the line has no newline and lasts until the next is read
+        char* input = next_line(&reader);
+        if (input == NULL) {
+            close_reader(&reader);
+            print_stdout(GAVE_UP);
+            if (data->listLadders == true) {
+                print_ladders(data);
+            }
+            my_exit(GAVE_UP_CODE, data);
+        }
+        make_caps(input);
+        check_input(input, data);
+    }
+}
+
+/* play_batch_game()
+* −−−−−−−−−−−−−−−
+* Plays one scripted game, given as the initial word, the target word and
+* then the moves, separated by whitespace. "?" moves are skipped.
+*
+* data: Struct containing all the data for the game.
+* record: line of the batch file, changed as it is split up
+* steps: set to the number of steps taken
+* rejected: set to the number of moves that were rejected
+*
+* Returns: outcome of the game, one of the BATCH_ strings
+*/
+const char* play_batch_game(Data* data, char* record, int* steps, 
+        int* rejected) {
+    char* save;
+    char* init = strtok_r(record, " \t\r\n", &save);
+    char* target = strtok_r(NULL, " \t\r\n", &save);
+    *steps = 0;
+    *rejected = 0;
+    if (init == NULL || target == NULL || strlen(init) != data->wordLen 
+            || strlen(target) != data->wordLen || check_chars(init) == false
+            || check_chars(target) == false 
+            || strcasecmp(init, target) == 0) {
+        return BATCH_INVALID;
+    }
+    make_caps(init);
+    make_caps(target);
+    data->initWord = init;
+    data->toWord = target;
+    data->attempt = 1;
+    start_ladder(data);
+    bool over = false;
+    const char* outcome = BATCH_GAVE_UP;
+    char* move;
+    while (over == false 
+            && (move = strtok_r(NULL, " \t\r\n", &save)) != NULL) {
+        if (strcmp(move, "?") == 0) {
+            continue;
+        }
+        make_caps(move);
+        MoveResult result = apply_move(data, move);
+        if (result == MOVE_SOLVED || result == MOVE_OUT_OF_STEPS) {
+            over = true;
+            outcome = result == MOVE_SOLVED ? BATCH_SOLVED : BATCH_OUT_OF_STEPS;
+        } else if (result != MOVE_ACCEPTED) {
+            (*rejected)++;
+        }
+    }
+    *steps = over ? data->attempt : data->attempt - 1;
+    //the visited bits are shared by every game this thread plays
+    forget_ladder(data);
+    return outcome;
+}
+
+/* take_chunk()
+* −−−−−−−−−−−−−−−
+* Takes a chunk of batch games from a worker's queue
+*
+* queue: queue to take from
+* steal: true to take from the back, as another worker does
+*
+* Returns: chunk number, or -1 if the queue is empty
+*/
+int take_chunk(BatchQueue* queue, bool steal) {
+    int chunk = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->next < queue->end) {
+        chunk = steal ? --queue->end : queue->next++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return chunk;
+}
+
+/* batch_worker()
+* −−−−−−−−−−−−−−−
+* Plays batch games until every queue is empty, taking chunks from its own
+* queue first and then stealing from the others. It has its own copy of the
+* game data, with its own arena for the given words, and only reads the
+* shared dictionary.
+*
+* arg: the BatchWorker for this thread
+*
+* Returns: NULL
+*/
+void* batch_worker(void* arg) {
+    BatchWorker* worker = (BatchWorker* )arg;
+    Data game = *worker->data;
+    game.arena = arena_create();
+    game.givenWords = (char** )arena_alloc(game.arena, 
+            sizeof(char*) * game.stepLim);
+    game.visited = (uint8_t* )arena_calloc(game.arena, 
+            game.wordsInDict / 8 + 1, 1);
+    for (int victim = 0; victim < worker->numWorkers; victim++) {
+        BatchQueue* queue = 
+                &worker->queues[(worker->self + victim) % worker->numWorkers];
+        int chunk;
+        while ((chunk = take_chunk(queue, victim != 0)) != -1) {
+            int end = (chunk + 1) * BATCH_CHUNK;
+            if (end > worker->numGames) {
+                end = worker->numGames;
+            }
+            for (int i = chunk * BATCH_CHUNK; i < end; i++) {
+                //each game's given words are released once it is scored
+                ArenaMark mark = arena_mark(game.arena);
+                BatchGame* batchGame = &worker->games[i];
+                batchGame->outcome = play_batch_game(&game, 
+                        batchGame->record, &batchGame->steps, 
+                        &batchGame->rejected);
+                arena_reset(game.arena, mark);
+            }
+        }
+    }
+    arena_release(game.arena);
+    return NULL;
+}
+
+/* split_batch()
+* −−−−−−−−−−−−−−−
+* Splits the contents of a batch file into its non-empty lines, which are
+* null terminated in place
+*
+* text: contents of the batch file, null terminated
+* size: number of bytes in text
+* numGames: set to the number of games
+*
+* Returns: allocated array of the games, must be freed
+*/
+BatchGame* split_batch(char* text, size_t size, int* numGames) {
+    int capacity = 1;
+    for (size_t i = 0; i < size; i++) {
+        capacity += text[i] == '\n';
+    }
+    BatchGame* games = (BatchGame* )malloc(sizeof(BatchGame) * capacity);
+    *numGames = 0;
+    unsigned long lineNum = 0;
+    char* line = text;
+    while (line < text + size) {
+        char* newline = memchr(line, '\n', text + size - line);
+        char* lineEnd = newline ? newline : text + size;
+        *lineEnd = '\0';
+        lineNum++;
+        if (strspn(line, " \t\r") != (size_t)(lineEnd - line)) {
+            games[*numGames].record = line;
+            games[*numGames].lineNum = lineNum;
+            (*numGames)++;
+        }
+        line = lineEnd + 1;
+    }
+    return games;
+}
+
+/* run_batch()
+* −−−−−−−−−−−−−−−
+* Replays every game in the batch file against the one dictionary, with
+* the same rules as an interactive game, and prints a result line for each
+* non-empty line: line number, outcome, steps taken and rejected moves.
+* Games are played in chunks by numThreads workers (default one per CPU)
+* that steal chunks from each other when they run out, and the results 
+* are printed in file order once all are played.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Error message prints and exits if the batch file can't be opened
+*/
+void run_batch(Data* data) {
+    int fd = open(data->batchFile, O_RDONLY);
+    if (fd == -1) {
+        fprintf(stderr, FILE_NOT_OPENING, data->batchFile);
+        my_exit(FILE_ERROR_CODE, data);
+    }
+    size_t size;
+    //the buffer is never full, so there is room to null terminate it
+    char* text = read_whole_file(fd, &size);
+    text[size] = '\0';
+    close(fd);
+    int numGames;
+    BatchGame* games = split_batch(text, size, &numGames);
+    int numChunks = (numGames + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    int numWorkers = data->numThreads != 0 ? data->numThreads 
+            : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numWorkers > numChunks) {
+        numWorkers = numChunks;
+    }
+    if (numWorkers < 1) {
+        numWorkers = 1;
+    }
+    BatchQueue* queues = (BatchQueue* )malloc(sizeof(BatchQueue) 
+            * numWorkers);
+    BatchWorker* workers = (BatchWorker* )malloc(sizeof(BatchWorker) 
+            * numWorkers);
+    pthread_t* threads = (pthread_t* )malloc(sizeof(pthread_t) * numWorkers);
+    for (int w = 0; w < numWorkers; w++) {
+        //each worker starts with an even share of consecutive chunks
+        pthread_mutex_init(&queues[w].lock, NULL);
+        queues[w].next = (long)numChunks * w / numWorkers;
+        queues[w].end = (long)numChunks * (w + 1) / numWorkers;
+        BatchWorker worker = {data, games, numGames, queues, numWorkers, w};
+        workers[w] = worker;
+    }
+    //this thread is worker 0
+    for (int w = 1; w < numWorkers; w++) {
+        pthread_create(&threads[w], NULL, batch_worker, &workers[w]);
+    }
+    batch_worker(&workers[0]);
+    for (int w = 1; w < numWorkers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    for (int i = 0; i < numGames; i++) {
+        fprintf(stdout, BATCH_RESULT, games[i].lineNum, games[i].outcome,
+                games[i].steps, games[i].rejected);
+    }
+    for (int w = 0; w < numWorkers; w++) {
+        pthread_mutex_destroy(&queues[w].lock);
+    }
+    free(threads);
+    free(workers);
+    free(queues);
+    free(games);
+    free(text);
+    my_exit(0, data);
+}
+
+/* dictionary_hash()
+* −−−−−−−−−−−−−−−
+* Hashes the filtered dictionary, so a distance table can be matched to
+* the words it was built from
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: FNV-1a hash of every word in dictionary order
+*/
+uint32_t dictionary_hash(Data* data) {
+    return hash_word(data->filteredDict,
+            (size_t)data->wordsInDict * (data->wordLen + 1));
+}
+
+/* layout_components()
+* −−−−−−−−−−−−−−−
+* Lays out a table per connected component, numbering the words of each
+* component in dictionary order
+*
+* data: Struct containing all the data for the game.
+* table: distance table, all but its distances are set
+*
+* Returns: Nothing
+*/
+void layout_components(Data* data, DistTable* table) {
+    table->numComponents = data->numComponents;
+    table->componentOf = data->componentOf;
+    for (int c = 0; c < data->numComponents; c++) {
+        table->sizes[c] = 0;
+    }
+    for (int i = 0; i < data->wordsInDict; i++) {
+        table->localIndex[i] = table->sizes[data->componentOf[i]]++;
+    }
+    //each component's table is its size squared
+    table->offsets[0] = 0;
+    for (int c = 0; c < data->numComponents; c++) {
+        table->offsets[c + 1] = table->offsets[c] 
+                + (uint64_t)table->sizes[c] * table->sizes[c];
+    }
+}
+
+/* distance_worker()
+* −−−−−−−−−−−−−−−
+* Runs a breadth first search from each source word in the chunks it
+* takes, filling in that word's row of its component's table. Rows start
+* as DIST_FAR, which marks a word as not yet reached.
+*
+* arg: the DistWorker for this thread
+*
+* Returns: NULL
+*/
+void* distance_worker(void* arg) {
+    DistWorker* worker = (DistWorker* )arg;
+    Data* data = worker->data;
+    DistTable* table = worker->table;
+    int* queue = (int* )malloc(sizeof(int) * (data->wordsInDict + 1));
+    int chunk;
+    while ((chunk = take_chunk(worker->queue, false)) != -1) {
+        int end = (chunk + 1) * DIST_CHUNK;
+        if (end > data->wordsInDict) {
+            end = data->wordsInDict;
+        }
+        for (int source = chunk * DIST_CHUNK; source < end; source++) {
+            uint32_t component = table->componentOf[source];
+            uint8_t* row = table->distances + table->offsets[component]
+                    + (uint64_t)table->localIndex[source]
+                    * table->sizes[component];
+            int head = 0, tail = 0;
+            queue[tail++] = source;
+            row[table->localIndex[source]] = 0;
+            while (head < tail) {
+                int word = queue[head++];
+                uint8_t next = row[table->localIndex[word]] + 1;
+                for (int n = data->adjStart[word];
+                        n < data->adjStart[word + 1]; n++) {
+                    int to = data->adjIds[n];
+                    uint8_t* dist = &row[table->localIndex[to]];
+                    if (*dist == DIST_FAR) {
+                        //distances past DIST_FAR - 1 are stored as it
+                        *dist = next < DIST_FAR ? next : DIST_FAR - 1;
+                        queue[tail++] = to;
+                    }
+                }
+            }
+        }
+    }
+    free(queue);
+    return NULL;
+}
+
+/* save_distances()
+* −−−−−−−−−−−−−−−
+* Writes the distance table to a file. It is written to a temporary file
+* first then renamed, so a partly written table is never read.
+*
+* data: Struct containing all the data for the game.
+* table: the distance table
+*
+* Returns: Nothing
+* Errors: Error message prints and exits if the file can't be written
+*/
+void save_distances(Data* data, DistTable* table) {
+    DistHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DIST_MAGIC, sizeof(DIST_MAGIC));
+    header.version = DIST_VERSION;
+    header.wordLen = data->wordLen;
+    header.wordsInDict = data->wordsInDict;
+    header.numComponents = table->numComponents;
+    header.dictHash = dictionary_hash(data);
+    char tempName[strlen(data->distBuildFile) + 16];
+    sprintf(tempName, CACHE_TEMP_NAME, data->distBuildFile, (int)getpid());
+    FILE* file = fopen(tempName, "w");
+    if (file != NULL) {
+        fwrite(&header, sizeof(header), 1, file);
+        fwrite(table->componentOf, sizeof(uint32_t), data->wordsInDict,
+                file);
+        fwrite(table->localIndex, sizeof(uint32_t), data->wordsInDict, file);
+        fwrite(table->offsets, sizeof(uint64_t), table->numComponents + 1,
+                file);
+        fwrite(table->sizes, sizeof(uint32_t), table->numComponents, file);
+        fwrite(table->distances, 1, table->offsets[table->numComponents],
+                file);
+    }
+    if (file == NULL || fclose(file) != 0
+            || rename(tempName, data->distBuildFile) != 0) {
+        unlink(tempName);
+        fprintf(stderr, FILE_NOT_WRITING, data->distBuildFile);
+        my_exit(FILE_ERROR_CODE, data);
+    }
+}
+
+/* build_distances()
+* −−−−−−−−−−−−−−−
+* Finds the shortest ladder length between every pair of dictionary words
+* and saves them as a table per connected component, one byte per pair.
+* Sources are searched in parallel by numThreads workers (default one per
+* CPU), each taking chunks of sources from a shared queue.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Error message prints and exits if the file can't be written
+*/
+void build_distances(Data* data) {
+    //the workers share the graph, so it is built before they start
+    use_graph(data);
+    DistTable table;
+    table.localIndex = (uint32_t* )malloc(sizeof(uint32_t)
+            * (data->wordsInDict + 1));
+    table.offsets = (uint64_t* )malloc(sizeof(uint64_t)
+            * (data->wordsInDict + 1));
+    table.sizes = (uint32_t* )malloc(sizeof(uint32_t)
+            * (data->wordsInDict + 1));
+    layout_components(data, &table);
+    table.distances = (uint8_t* )malloc(table.offsets[table.numComponents]
+            + 1);
+    memset(table.distances, DIST_FAR, table.offsets[table.numComponents]);
+    BatchQueue queue;
+    pthread_mutex_init(&queue.lock, NULL);
+    queue.next = 0;
+    queue.end = (data->wordsInDict + DIST_CHUNK - 1) / DIST_CHUNK;
+    int numWorkers = data->numThreads != 0 ? data->numThreads
+            : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (numWorkers < 1) {
+        numWorkers = 1;
+    }
+    DistWorker worker = {data, &table, &queue};
+    pthread_t* threads = (pthread_t* )malloc(sizeof(pthread_t) * numWorkers);
+    //this thread is a worker too
+    for (int w = 1; w < numWorkers; w++) {
+        pthread_create(&threads[w], NULL, distance_worker, &worker);
+    }
+    distance_worker(&worker);
+    for (int w = 1; w < numWorkers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+    free(threads);
+    save_distances(data, &table);
+    free(table.localIndex);
+    free(table.offsets);
+    free(table.sizes);
+    free(table.distances);
+    my_exit(0, data);
+}
+
+/* print_optimal()
+* −−−−−−−−−−−−−−−
+* Prints the shortest ladder length from the initial word to the target
+* word, looked up in the distance table. Nothing is printed if either
+* word isn't in the dictionary, or the table can't be read, was built
+* from another dictionary or word length, or points outside itself for
+* these words. Distances too long for the
+* table are stored as its cap, so that is printed as a lower bound.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void print_optimal(Data* data) {
+    int from = dict_index(data->initWord, data);
+    int to = dict_index(data->toWord, data);
+    int fd = open(data->distFile, O_RDONLY);
+    struct stat info;
+    if (from == -1 || to == -1 || fd == -1 || fstat(fd, &info) == -1
+            || (size_t)info.st_size < sizeof(DistHeader)) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return;
+    }
+    char* map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return;
+    }
+    DistHeader header;
+    memcpy(&header, map, sizeof(header));
+    //the words' arrays, then the offsets and sizes of the components
+    size_t arrays = sizeof(header) + 2 * sizeof(uint32_t) * header.wordsInDict;
+    size_t tables = arrays + sizeof(uint64_t) * (header.numComponents + 1)
+            + sizeof(uint32_t) * header.numComponents;
+    const uint64_t* offsets = (const uint64_t* )(map + arrays);
+    if (memcmp(header.magic, DIST_MAGIC, sizeof(DIST_MAGIC)) != 0
+            || header.version != DIST_VERSION
+            || header.wordLen != data->wordLen
+            || header.wordsInDict != (uint32_t)data->wordsInDict
+            || header.dictHash != dictionary_hash(data)
+            || (size_t)info.st_size < tables
+            || (size_t)info.st_size - tables 
+            != offsets[header.numComponents]) {
+        munmap(map, info.st_size);
+        return;
+    }
+    const uint32_t* componentOf = (const uint32_t* )(map + sizeof(header));
+    const uint32_t* localIndex = componentOf + header.wordsInDict;
+    const uint32_t* sizes = (const uint32_t* )(offsets
+            + header.numComponents + 1);
+    const uint8_t* distances = (const uint8_t* )(map + tables);
+    uint32_t component = componentOf[from];
+    //a corrupt table could point anywhere, so only its own bytes are read
+    if (component >= header.numComponents 
+            || componentOf[to] >= header.numComponents) {
+        munmap(map, info.st_size);
+        return;
+    }
+    uint64_t tableSize = (uint64_t)sizes[component] * sizes[component];
+    if (component != componentOf[to]) {
+        fprintf(stdout, OPTIMAL_NONE);
+    } else if (localIndex[from] < sizes[component] 
+            && localIndex[to] < sizes[component]
+            && offsets[component] <= (size_t)info.st_size - tables
+            && tableSize <= (size_t)info.st_size - tables 
+            - offsets[component]) {
+        uint8_t steps = distances[offsets[component]
+                + (uint64_t)localIndex[from] * sizes[component]
+                + localIndex[to]];
+        //DIST_FAR - 1 also stands for every longer distance
+        fprintf(stdout, steps == DIST_FAR - 1 ? OPTIMAL_AT_LEAST
+                : OPTIMAL_STEPS, steps);
+    }
+    munmap(map, info.st_size);
+}
+
+/* print_graph_stats()
+* −−−−−−−−−−−−−−−
+* Prints the size of the one letter difference graph of the dictionary,
+* its connected components and the degrees of its words, then exits
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void print_graph_stats(Data* data) {
+    use_graph(data);
+    int minDegree = 0, maxDegree = 0, isolated = 0, largest = 0;
+    for (int i = 0; i < data->wordsInDict; i++) {
+        int degree = data->adjStart[i + 1] - data->adjStart[i];
+        if (i == 0 || degree < minDegree) {
+            minDegree = degree;
+        }
+        if (degree > maxDegree) {
+            maxDegree = degree;
+        }
+        isolated += degree == 0;
+    }
+    int* sizes = (int* )calloc(data->numComponents + 1, sizeof(int));
+    for (int i = 0; i < data->wordsInDict; i++) {
+        if (++sizes[data->componentOf[i]] > largest) {
+            largest = sizes[data->componentOf[i]];
+        }
+    }
+    free(sizes);
+    //every edge is in the rows of both its words
+    long degrees = data->adjStart[data->wordsInDict];
+    fprintf(stdout, GRAPH_STATS, data->wordsInDict, degrees / 2, 
+            data->numComponents, largest, isolated, minDegree, maxDegree,
+            data->wordsInDict ? (double)degrees / data->wordsInDict : 0.0);
+    my_exit(0, data);
+}
+
+/* now_ns()
+* −−−−−−−−−−−−−−−
+* Reads the monotonic clock
+*
+* Returns: the time in nanoseconds
+*/
+uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+/* bench_random()
+* −−−−−−−−−−−−−−−
+* Steps a xorshift generator, so every benchmark run draws the same words
+*
+* state: generator state, never 0, updated
+*
+* Returns: the next random number
+*/
+uint64_t bench_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/* report_bench()
+* −−−−−−−−−−−−−−−
+* Prints one benchmark's results as a JSON object: percentiles of the time
+* per operation and the operations per second at the median
+*
+* name: name of the benchmark
+* samples: time taken by each sample in nanoseconds, sorted here
+* count: number of samples
+* opsPerSample: operations timed by each sample
+* bytesPerOp: bytes each operation reads, 0 if not a throughput benchmark
+* wordsPerOp: words each operation reads, 0 if not a throughput benchmark
+* last: if no benchmark follows it
+*
+* Returns: Nothing
+*/
+void report_bench(const char* name, uint64_t* samples, int count, 
+        int opsPerSample, size_t bytesPerOp, int wordsPerOp, bool last) {
+    qsort(samples, count, sizeof(uint64_t), compare_uint64s);
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += samples[i];
+    }
+    //nearest rank percentiles, per operation
+    int ranks[] = {0, 50, 90, 99, 100};
+    double perOp[5];
+    for (int r = 0; r < 5; r++) {
+        perOp[r] = (double)samples[(count - 1) * ranks[r] / 100] 
+                / opsPerSample;
+    }
+    fprintf(stdout, BENCH_RESULT, name, count, opsPerSample, perOp[0], 
+            perOp[1], perOp[2], perOp[3], perOp[4], 
+            total / count / opsPerSample, 1e9 / perOp[1]);
+    if (bytesPerOp != 0) {
+        fprintf(stdout, BENCH_THROUGHPUT, bytesPerOp / perOp[1] * 1e3,
+                wordsPerOp / perOp[1] * 1e9);
+    }
+    fprintf(stdout, last ? "}\n" : "},\n");
+}
+
+/* print_json_string()
+* −−−−−−−−−−−−−−−
+* Prints text as a quoted JSON string, escaping what JSON needs escaped
+*
+* text: the text to print
+*
+* Returns: Nothing
+*/
+void print_json_string(const char* text) {
+    fputc('"', stdout);
+    for (const unsigned char* c = (const unsigned char* )text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(stdout, "\\%c", *c);
+        } else if (*c < ' ') {
+            fprintf(stdout, "\\u%04x", *c);
+        } else {
+            fputc(*c, stdout);
+        }
+    }
+    fputc('"', stdout);
+}
+
+/* make_bench_dict()
+* −−−−−−−−−−−−−−−
+* Writes a synthetic dictionary of benchWords distinct random words to a
+* temporary file and uses it as the dictionary. Letters are drawn from the
+* first BENCH_ALPHABET of the alphabet, so the words are about as close
+* together as in a real dictionary, or from more of it if there would be
+* fewer than twice benchWords words to draw from. If the whole alphabet
+* can't make benchWords words, every word it can make is written. The
+* file is removed by my_exit().
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+* Errors: Error message prints and exits if the file can't be written
+*/
+void make_bench_dict(Data* data) {
+    char* name = arena_strdup(data->arena, BENCH_DICT);
+    int fd = mkstemp(name);
+    data->benchDict = fd == -1 ? NULL : name;
+    FILE* file = fd == -1 ? NULL : fdopen(fd, "w");
+    if (file == NULL) {
+        fprintf(stderr, FILE_NOT_WRITING, BENCH_DICT);
+        my_exit(FILE_ERROR_CODE, data);
+    }
+    int alphabet = BENCH_ALPHABET;
+    uint64_t possible = 0;
+    for (int letters = BENCH_ALPHABET; letters <= 26 
+            && possible < 2 * (uint64_t)data->benchWords; letters++) {
+        alphabet = letters;
+        possible = 1;
+        for (unsigned int j = 0; j < data->wordLen; j++) {
+            possible *= letters;
+        }
+    }
+    long numWords = (uint64_t)data->benchWords < possible ? data->benchWords
+            : (long)possible;
+    //words drawn so far, packed, so repeats are drawn again
+    unsigned int size = hash_table_size(numWords);
+    uint64_t* drawn = (uint64_t* )calloc(size, sizeof(uint64_t));
+    uint64_t state = BENCH_SEED;
+    char word[MAX_LENGTH + 1];
+    for (long i = 0; i < numWords; i++) {
+        uint64_t key;
+        unsigned int slot;
+        do {
+            for (unsigned int j = 0; j < data->wordLen; j++) {
+                word[j] = 'a' + bench_random(&state) % alphabet;
+            }
+            key = pack_word(word, data->wordLen);
+            slot = (unsigned int)((key * KEY_MULTIPLIER) >> 32) & (size - 1);
+            while (drawn[slot] != 0 && drawn[slot] != key) {
+                slot = (slot + 1) & (size - 1);
+            }
+        } while (drawn[slot] == key);
+        drawn[slot] = key;
+        word[data->wordLen] = '\0';
+        fprintf(file, "%s\n", word);
+    }
+    free(drawn);
+    fclose(file);
+    data->dict = name;
+    data->dictSet = true;
+}
+
+/* bench_load()
+* −−−−−−−−−−−−−−−
+* Times loading the dictionary again into fresh game data, for up to
+* BENCH_MAX_LOADS samples
+*
+* data: Struct containing all the data for the game, already loaded
+* samples: room for the samples
+* numSamples: number of samples asked for
+*
+* Returns: Nothing
+*/
+void bench_load(Data* data, uint64_t* samples, int numSamples) {
+    int loads = numSamples < BENCH_MAX_LOADS ? numSamples : BENCH_MAX_LOADS;
+    struct stat info;
+    size_t bytes = stat(data->dict, &info) == 0 ? info.st_size : 0;
+    for (int i = 0; i < loads; i++) {
+        Data load = *data;
+        load.arena = arena_create();
+        load.cacheMap = NULL;
+        load.wordsInDict = 0;
+        load.adjStart = NULL;
+        uint64_t start = now_ns();
+        read_dictionary(&load);
+        samples[i] = now_ns() - start;
+        if (load.cacheMap != NULL) {
+            munmap(load.cacheMap, load.cacheMapSize);
+        }
+        arena_release(load.arena);
+    }
+    fprintf(stdout, "{\"dictionary\": ");
+    print_json_string(data->benchWords != 0 ? "synthetic" : data->dict);
+    fprintf(stdout, BENCH_DICT_INFO, data->wordLen, data->wordsInDict, 
+            bytes);
+    report_bench("read_dictionary", samples, loads, 1, bytes > 0 ? bytes 
+            : 1, data->wordsInDict, false);
+}
+
+/* bench_lookups()
+* −−−−−−−−−−−−−−−
+* Times dictionary lookups of words that are in it and of random strings,
+* which almost never are, BENCH_BATCH to a sample
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_lookups(Data* data, uint64_t* samples, int numSamples) {
+    uint64_t state = BENCH_SEED;
+    char* misses = (char* )malloc(BENCH_BATCH * (data->wordLen + 1));
+    char* hits[BENCH_BATCH];
+    for (int i = 0; i < BENCH_BATCH; i++) {
+        hits[i] = dict_word(data, bench_random(&state) % data->wordsInDict);
+        char* miss = misses + i * (data->wordLen + 1);
+        for (unsigned int j = 0; j < data->wordLen; j++) {
+            miss[j] = 'A' + bench_random(&state) % 26;
+        }
+        miss[data->wordLen] = '\0';
+    }
+    volatile int sink = 0;
+    for (int s = 0; s < numSamples; s++) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            sink += dict_index(hits[i], data);
+        }
+        samples[s] = now_ns() - start;
+    }
+    report_bench("dict_index_hit", samples, numSamples, BENCH_BATCH, 0, 0,
+            false);
+    for (int s = 0; s < numSamples; s++) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            sink += dict_index(misses + i * (data->wordLen + 1), data);
+        }
+        samples[s] = now_ns() - start;
+    }
+    report_bench("dict_index_miss", samples, numSamples, BENCH_BATCH, 0, 0,
+            false);
+    free(misses);
+}
+
+/* bench_one_diff()
+* −−−−−−−−−−−−−−−
+* Times one_letter_diff() on pairs of dictionary words, half of them
+* neighbours, BENCH_BATCH to a sample
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_one_diff(Data* data, uint64_t* samples, int numSamples) {
+    uint64_t state = BENCH_SEED;
+    char* first[BENCH_BATCH];
+    char* second[BENCH_BATCH];
+    for (int i = 0; i < BENCH_BATCH; i++) {
+        int word = bench_random(&state) % data->wordsInDict;
+        int degree = data->adjStart[word + 1] - data->adjStart[word];
+        int other = bench_random(&state) % data->wordsInDict;
+        if (i % 2 == 0 && degree > 0) {
+            other = data->adjIds[data->adjStart[word] 
+                    + bench_random(&state) % degree];
+        }
+        first[i] = dict_word(data, word);
+        second[i] = dict_word(data, other);
+    }
+    volatile int sink = 0;
+    for (int s = 0; s < numSamples; s++) {
+        uint64_t start = now_ns();
+        for (int i = 0; i < BENCH_BATCH; i++) {
+            sink += one_letter_diff(first[i], second[i]);
+        }
+        samples[s] = now_ns() - start;
+    }
+    report_bench("one_letter_diff", samples, numSamples, BENCH_BATCH, 0, 0,
+            false);
+}
+
+/* bench_suggestions()
+* −−−−−−−−−−−−−−−
+* Times print_suggestions() from random dictionary words, one call to a
+* sample. Its output goes to /dev/null and is flushed within the sample.
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_suggestions(Data* data, uint64_t* samples, int numSamples) {
+    uint64_t state = BENCH_SEED;
+    data->initWord = dict_word(data, 0);
+    data->toWord = dict_word(data, data->wordsInDict - 1);
+    data->attempt = 1;
+    start_ladder(data);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    for (int s = 0; s < numSamples; s++) {
+        char* previous = dict_word(data, 
+                bench_random(&state) % data->wordsInDict);
+        uint64_t start = now_ns();
+        print_suggestions(data, previous);
+        fflush(stdout);
+        samples[s] = now_ns() - start;
+    }
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(devNull);
+    report_bench("print_suggestions", samples, numSamples, 1, 0, 0, false);
+}
+
+/* bench_walk()
+* −−−−−−−−−−−−−−−
+* Takes a random walk over the word graph from a random word, of up to
+* stepLim - 1 moves, stopping early at a word with no neighbours. Words
+* may repeat, so games played along it mix in rejected moves.
+*
+* data: Struct containing all the data for the game.
+* state: generator state, updated
+* walk: set to the dictionary index of each word after the first, must
+* have room for MAX_STEP
+* steps: set to the number of moves taken
+*
+* Returns: dictionary index of the first word
+*/
+int bench_walk(Data* data, uint64_t* state, int* walk, int* steps) {
+    int origin = bench_random(state) % data->wordsInDict;
+    int word = origin;
+    *steps = 0;
+    while (*steps < (int)data->stepLim - 1) {
+        int degree = data->adjStart[word + 1] - data->adjStart[word];
+        if (degree == 0) {
+            break;
+        }
+        word = data->adjIds[data->adjStart[word] 
+                + bench_random(state) % degree];
+        walk[(*steps)++] = word;
+    }
+    return origin;
+}
+
+/* bench_solvers()
+* −−−−−−−−−−−−−−−
+* Times solve_ladder() with each --solve-algo search, one ladder to a
+* sample. Every search solves the same pairs: the ends of random walks,
+* so each pair has a ladder within stepLim unless the walk went nowhere.
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_solvers(Data* data, uint64_t* samples, int numSamples) {
+    const char* names[] = {"solve_bfs", "solve_astar", "solve_idastar"};
+    SolveAlgo chosen = data->solveAlgo;
+    for (int algo = SOLVE_BFS; algo < SOLVE_UNKNOWN; algo++) {
+        uint64_t state = BENCH_SEED;
+        data->solveAlgo = algo;
+        for (int s = 0; s < numSamples; s++) {
+            int walk[MAX_STEP];
+            int steps;
+            int origin = bench_walk(data, &state, walk, &steps);
+            data->initWord = dict_word(data, origin);
+            data->toWord = dict_word(data, steps > 0 ? walk[steps - 1] 
+                    : origin);
+            int* ladder;
+            uint64_t start = now_ns();
+            solve_ladder(data, &ladder);
+            samples[s] = now_ns() - start;
+            free(ladder);
+        }
+        report_bench(names[algo], samples, numSamples, 1, 0, 0, false);
+    }
+    data->solveAlgo = chosen;
+}
+
+/* bench_moves()
+* −−−−−−−−−−−−−−−
+* Times apply_move(), the per-move cost of the game, BENCH_BATCH moves to
+* a sample. The moves are bench_walk() games, each targeting where its
+* walk ends, and the last game is cut short so every sample plays exactly
+* BENCH_BATCH moves. Starting and forgetting each game is timed too, as it
+* is part of playing its moves.
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_moves(Data* data, uint64_t* samples, int numSamples) {
+    uint64_t state = BENCH_SEED;
+    int* origins = (int* )malloc(sizeof(int) * BENCH_BATCH);
+    int* ends = (int* )malloc(sizeof(int) * BENCH_BATCH);
+    int* firstMove = (int* )malloc(sizeof(int) * (BENCH_BATCH + 1));
+    int* moves = (int* )malloc(sizeof(int) * (BENCH_BATCH + MAX_STEP));
+    int numGames = 0, numMoves = 0;
+    //a dictionary with no edges can't make a move, so give up on it
+    for (int tries = 0; numMoves < BENCH_BATCH && tries < BENCH_BATCH;
+            tries++) {
+        int steps;
+        int origin = bench_walk(data, &state, moves + numMoves, &steps);
+        if (steps > 0) {
+            origins[numGames] = origin;
+            ends[numGames] = moves[numMoves + steps - 1];
+            firstMove[numGames++] = numMoves;
+            numMoves += steps;
+        }
+    }
+    numMoves = numMoves < BENCH_BATCH ? numMoves : BENCH_BATCH;
+    firstMove[numGames] = numMoves;
+    start_ladder(data);
+    for (int s = 0; s < numSamples; s++) {
+        ArenaMark mark = arena_mark(data->arena);
+        uint64_t start = now_ns();
+        for (int g = 0; g < numGames; g++) {
+            data->initWord = dict_word(data, origins[g]);
+            data->toWord = dict_word(data, ends[g]);
+            data->attempt = 1;
+            for (int m = firstMove[g]; m < firstMove[g + 1]; m++) {
+                MoveResult result = apply_move(data, 
+                        dict_word(data, moves[m]));
+                if (result == MOVE_SOLVED || result == MOVE_OUT_OF_STEPS) {
+                    break;
+                }
+            }
+            forget_ladder(data);
+        }
+        samples[s] = now_ns() - start;
+        arena_reset(data->arena, mark);
+    }
+    free(origins);
+    free(ends);
+    free(firstMove);
+    free(moves);
+    report_bench("apply_move", samples, numSamples, numMoves > 0 ? numMoves 
+            : 1, 0, 0, false);
+}
+
+/* bench_games()
+* −−−−−−−−−−−−−−−
+* Times whole scripted games, one to a sample. Each is a bench_walk(),
+* targeting where the walk ends, so games mix solved ones with rejected
+* repeats.
+*
+* data: Struct containing all the data for the game.
+* samples: room for the samples
+* numSamples: number of samples
+*
+* Returns: Nothing
+*/
+void bench_games(Data* data, uint64_t* samples, int numSamples) {
+    uint64_t state = BENCH_SEED;
+    size_t recordSize = (data->stepLim + 2) * (data->wordLen + 1) + 1;
+    char* script = (char* )malloc(recordSize);
+    char* record = (char* )malloc(recordSize);
+    for (int s = 0; s < numSamples; s++) {
+        int walk[MAX_STEP];
+        int steps;
+        int origin = bench_walk(data, &state, walk, &steps);
+        int word = steps > 0 ? walk[steps - 1] : origin;
+        //the initial word, the target, then the moves
+        char* next = script + sprintf(script, "%s %s", 
+                dict_word(data, origin), dict_word(data, word));
+        for (int i = 0; i < steps; i++) {
+            next += sprintf(next, " %s", dict_word(data, walk[i]));
+        }
+        memcpy(record, script, recordSize);
+        int moves, rejected;
+        ArenaMark mark = arena_mark(data->arena);
+        uint64_t start = now_ns();
+        play_batch_game(data, record, &moves, &rejected);
+        samples[s] = now_ns() - start;
+        arena_reset(data->arena, mark);
+    }
+    free(script);
+    free(record);
+    report_bench("scripted_game", samples, numSamples, 1, 0, 0, true);
+}
+
+/* run_bench()
+* −−−−−−−−−−−−−−−
+* Benchmarks the hot paths of the game against the loaded dictionary and
+* prints the results as JSON, then exits. Every benchmark takes
+* benchSamples samples, bar reloading the dictionary.
+*
+* data: Struct containing all the data for the game.
+*
+* Returns: Nothing
+*/
+void run_bench(Data* data) {
+    if (data->wordsInDict == 0) {
+        fprintf(stderr, BENCH_EMPTY);
+        my_exit(FILE_ERROR_CODE, data);
+    }
+    use_graph(data);
+    uint64_t* samples = (uint64_t* )malloc(sizeof(uint64_t) 
+            * data->benchSamples);
+    bench_load(data, samples, data->benchSamples);
+    bench_lookups(data, samples, data->benchSamples);
+    bench_one_diff(data, samples, data->benchSamples);
+    bench_suggestions(data, samples, data->benchSamples);
+    bench_solvers(data, samples, data->benchSamples);
+    bench_moves(data, samples, data->benchSamples);
+    bench_games(data, samples, data->benchSamples);
+    fprintf(stdout, "]}\n");
+    free(samples);
+    my_exit(0, data);
+}
+
+int main(int argc, char* argv[]) {
+    //the one copy of the game's data, every stage updates it in place
+    Data data;
+    set_false(&data);
+    check_command_line(&data, argc, argv);
+    length_check(&data);
+    if (data.batchFile != NULL || data.distBuildFile != NULL 
+            || data.graphStats == true || data.benchSamples != 0) {
+        step_check(&data);
+        if (data.benchWords != 0) {
+            make_bench_dict(&data);
+        }
+        read_dictionary(&data);
+        if (data.batchFile != NULL) {
+            run_batch(&data);
+        } else if (data.graphStats == true) {
+            print_graph_stats(&data);
+        } else if (data.benchSamples != 0) {
+            run_bench(&data);
+        }
+        build_distances(&data);
+    }
+    word_check(&data);
+    step_check(&data);
+    read_dictionary(&data);
+    reject_unsolvable(&data);
+    if (data.solve == true) {
+        print_ladder(&data);
+    }
+    //Welcome message
+    fprintf(stdout, WELCOME, data.initWord, data.toWord, data.stepLim);
+    if (data.hopeless != HOPELESS_IGNORE || data.rankHints == true) {
+        build_target_map(&data);
+    }
+    if (data.distFile != NULL) {
+        print_optimal(&data);
+    }
     //starts loop
-    game_loop(data);
+    start_ladder(&data);
+    game_loop(&data);
 }
\ No newline at end of file